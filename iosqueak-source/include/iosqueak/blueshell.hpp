@@ -50,7 +50,12 @@
 #include <string>
 
 #include "iosqueak/channel.hpp"
+#include "iosqueak/cmd_history.hpp"
+#include "iosqueak/cmd_jobs.hpp"
 #include "iosqueak/cmd_map.hpp"
+#include "iosqueak/cmd_tokenizer.hpp"
+#include "iosqueak/linerenderer.hpp"
+#include "iosqueak/rawterminal.hpp"
 
 using namespace std::placeholders;
 using _register = std::function<int(std::deque<std::string>&)>;
@@ -60,6 +65,21 @@ class Blueshell
 public:
 	using arguments = std::deque<std::string>;
 
+	// Returned by process_command() for commands that aren't registered.
+	static constexpr int unknown_command = 127;
+	// Returned by process_command() when given the wrong number of arguments.
+	static constexpr int wrong_arguments = 2;
+
+	// The combined result of running a script (see run_string()).
+	struct batch_result {
+		// The number of commands run.
+		size_t commands{0};
+		// The number of those that returned nonzero.
+		size_t failures{0};
+		// What the first failing command returned, or 0 if none failed.
+		int status{0};
+	};
+
 private:
 	/* Used to store the command entered. Needed here as it will
 	 * be used in multiple cpp files. */
@@ -75,18 +95,43 @@ private:
 	// Used to store location of cursor when moving left/right.
 	int cursor_moves{0};
 
+	// Whether the default commands were registered yet.
+	bool defaults_registered{false};
+
 	// Bools for checking for open ' or " in commands.
 	bool inner_quote{false};
 	bool outer_quote{false};
 	bool inner_single{false};
 	bool outer_single{false};
 
-	// A container to store previously called commands.
-	std::deque<std::pair<int, std::string>> previous_commands;
+	/* A container to store previously called commands, most recent first.
+	 * Optionally kept in a file (see load_history()). */
+	Cmd_history previous_commands;
 
 	// This is for previous_commands vector call.
 	size_t vec_size{0};
 
+	// The terminal keypresses are read from.
+	RawTerminal terminal;
+
+	// Draws the command line, only updating what changed.
+	LineRenderer line;
+
+	// Splits commands into words.
+	Cmd_tokenizer tokenizer;
+
+	// Runs commands ending in & in the background.
+	Cmd_jobs jobs;
+
+	/* Whether the shell is showing the channel's output itself, above the
+	 * line being edited (see capture_output()). */
+	bool capturing{false};
+	Channel::IOSignalFullView::Handle capture_handle;
+	// The channel's echo settings from before capturing, to restore after.
+	IOEchoMode saved_echo{IOEchoMode::cout};
+	IOVrb saved_vrb{IOVrb::tmi};
+	IOCat saved_cat{IOCat::all};
+
 	// Returns the key that was pressed.
 	int getch(void);
 
@@ -108,6 +153,10 @@ private:
 	// Function for !# history option.
 	int bang(std::string&);
 
+	/* Function for Ctrl-R, searching the history as the query is typed.
+	 * Returns the key that ended the search, to be handled as usual. */
+	size_t reverse_search(std::string&);
+
 	// Function to insert characters typed
 	void insert_char(std::string&, int);
 
@@ -120,11 +169,17 @@ private:
 	// Displays the available commands that can be run.
 	int help(arguments&);
 
-	// Process the command when enter is pressed.
-	void process_command(std::string&);
+	/* Process the command when enter is pressed. Returns what the command
+	 * returned, or unknown_command/wrong_arguments. The command is only
+	 * added to the history if asked. */
+	int process_command(std::string&, bool record = true);
 
-	// Process string for finding flags/options sent.
-	arguments process_options(std::string&);
+	/* Run a single line of a script. Returns false if the script should
+	 * stop (quit/exit, or a failure when stopping on errors). */
+	bool run_line(std::string_view, batch_result&, bool stop_on_error);
+
+	// Copy the options/flags sent (every word but the command).
+	arguments process_options(const Cmd_tokenizer::tokens&);
 
 	// Print out description in help command
 	void print_string(const std::string&);
@@ -136,8 +191,9 @@ private:
 	void check_quote(std::string&);
 
 	/* Function to break string into tokens
-	 * that will be used in various functions.*/
-	std::deque<std::string> tokens(std::string&);
+	 * that will be used in various functions. They are only valid
+	 * until the string or the next call changes.*/
+	const Cmd_tokenizer::tokens& tokens(std::string_view);
 
 	// Function to add command to stored_commands container.
 	void add_command(std::string&);
@@ -145,6 +201,20 @@ private:
 	// Function to list all registered commands.
 	int list_commands(arguments&);
 
+	/* Run a command in the background, and say so. The line is the
+	 * command as typed, without the &. Returns 0. */
+	int start_job(std::string_view, std::function<int()>);
+
+	/* Once background jobs are started, their output could arrive while a
+	 * line is being edited. So channel's echo is turned off, and the shell
+	 * shows the output itself, redrawing the line after it. */
+	void capture_output(bool);
+
+	// The jobs, wait and cancel commands.
+	int list_jobs(arguments&);
+	int wait_jobs(const Cmd_args&);
+	int cancel_job(const Cmd_args&);
+
 public:
 	/* A map that has the stored commands that are available during
 	 * the running of Blueshell. Use the 'register' function to
@@ -160,6 +230,24 @@ public:
 	// Just starts the shell to make it interactive.
 	void initial_shell();
 
+	/* Keep the history of commands in a file, loading the most recent
+	 * commands from it. Returns false if the file couldn't be opened. */
+	bool load_history(const std::string& path);
+
+	/* Run commands from a file descriptor (e.g. piped stdin), one per line,
+	 * without any terminal input or redrawing. Blank lines and lines
+	 * starting with # are skipped, and 'quit' or 'exit' stops the script.
+	 * Commands aren't added to the history. If stop_on_error is true, the
+	 * script stops at the first command that fails. */
+	batch_result run_fd(int fd, bool stop_on_error = false);
+
+	// Run commands from a file, as with run_fd().
+	batch_result run_file(const std::string& path, bool stop_on_error = false);
+
+	// Run commands from a string, one per line, as with run_fd().
+	batch_result run_string(std::string_view script,
+							bool stop_on_error = false);
+
 	/*This is for registering commands. All commands MUST already meet the
 	 *  function signature before being able to be used. The signature is:
 	 *  int <function name>(arguments&)*/
@@ -169,6 +257,16 @@ public:
 						 const std::string& long_desc = std::string(),
 						 int num_of_args = 0);
 
+	/* Register a command whose arguments are declared with a schema. The
+	 * shell checks and parses them before the command runs, and reports
+	 * any that don't fit along with the command's usage. The signature is:
+	 *  int <function name>(const Cmd_args&)*/
+	int register_command(const std::string&,
+						 _typed_register,
+						 Cmd_schema,
+						 const std::string& short_desc = std::string(),
+						 const std::string& long_desc = std::string());
+
 	// Empty container for passing to functions.
 	arguments empty_container;
 
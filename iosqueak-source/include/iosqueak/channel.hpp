@@ -79,10 +79,21 @@
 // Needed for handling passed-in exceptions.
 #include <exception>
 #include <string>
+#include <string_view>
 
 // We use C's classes often.
 #include <cstdio>
 
+// Needed for asynchronous dispatch and per-thread messages.
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 // Signals and callbacks.
 #include "eventpp/callbacklist.h"
 
@@ -91,16 +102,91 @@
 #include "iosqueak/ioctrl.hpp"
 #include "iosqueak/ioformat.hpp"
 #include "iosqueak/stringify.hpp"
+#include "iosqueak/utilities/boundedqueue.hpp"
 
 class Channel
 {
 protected:
-	std::string buffer;
+	/// A finished message, waiting to be dispatched by the writer thread.
+	struct Record {
+		std::string buffer;
+		IOVrb vrb = IOVrb::normal;
+		IOCat cat = IOCat::normal;
+		/// Whether to flush the standard streams after dispatching.
+		bool flush = false;
+	};
+
+	/** The message currently being composed by a single thread.
+	 * Every thread gets its own, so concurrent messages never interleave.
+	 */
+	struct Builder {
+		std::string buffer;
+
+		// Message attributes.
+		IOFormat fmt;
+		IOVrb vrb = IOVrb::normal;
+		IOCat cat = IOCat::normal;
+
+		// Message parsable?
+		tril parse = maybe;
+		/// The configuration generation `parse` was last validated against.
+		unsigned int generation = 0;
+
+		/// Dirty flag raised when attributes are changed and not yet applied.
+		bool dirty_attributes = false;
+
+		/// Whether any attributes have been applied in this message yet.
+		bool emitted = false;
+		/// The attributes most recently applied in this message.
+		IOFormatTextAttr emitted_attr = IOFormatTextAttr::none;
+		IOFormatTextBG emitted_bg = IOFormatTextBG::none;
+		IOFormatTextFG emitted_fg = IOFormatTextFG::none;
+	};
+
+	/// Source of unique Channel identifiers, used to find thread builders.
+	static inline std::atomic<uint64_t> next_id{1};
+	/// This channel's unique identifier. Never reused.
+	const uint64_t id;
+
+	/** Every thread's message builder for this channel, by thread. These
+	 * belong to the channel, so they are released along with it. */
+	std::unordered_map<std::thread::id, std::unique_ptr<Builder>> builders;
+	/// Guards `builders`. Only taken when a thread switches channels.
+	std::mutex builders_lock;
+
+	/* The calling thread's most recently used builder, and the identifier
+	 * of its channel. Identifiers are never reused, so a stale entry can
+	 * never match a live channel. These are trivially destructible, so
+	 * using them during static destruction is safe. */
+	static thread_local uint64_t last_id;
+	static thread_local Builder* last_builder;
+
+	/** The channels a thread has a builder on. When the thread exits, its
+	 * builders are released from whichever of them still exist, so a new
+	 * thread which happens to get the same id starts from scratch. */
+	struct ThreadBuilders {
+		std::vector<uint64_t> channels;
+		~ThreadBuilders();
+	};
+	static thread_local ThreadBuilders thread_builders;
+	/* Raised once the calling thread has released its builders, so any
+	 * late messages (such as during static destruction) don't register
+	 * again. Trivially destructible, like the above. */
+	static thread_local bool thread_exiting;
+
+	/** Add this channel to the channels that exiting threads look in. */
+	void enroll();
+
+	/** Remove this channel from the channels that exiting threads look in.
+	 */
+	void withdraw();
 
 	/// Which categories are permitted.
-	IOCat process_cat;
+	std::atomic<IOCat> process_cat;
 	/// The maximum verbosity to permit.
-	IOVrb process_vrb;
+	std::atomic<IOVrb> process_vrb;
+	/// Bumped whenever the processing rules change, to revalidate parsing.
+	std::atomic<unsigned int> generation;
 
 	// Which method should be used for Channel's default standard stream echo?
 	IOEchoMode echo_mode;
@@ -109,16 +195,37 @@ protected:
 	// The maximum verbosity to echo.
 	IOVrb echo_vrb;
 
-	// Message attributes.
-	IOFormat fmt;
-	IOVrb vrb;
-	IOCat cat;
-
-	// Message parsable?
-	tril parse;
-
-	/// Dirty flag raised when attributes are changed and not yet applied.
-	bool dirty_attributes;
+	/// Serializes synchronous dispatch between threads.
+	std::recursive_mutex dispatch_lock;
+
+	/// Whether messages are dispatched on the calling or the writer thread.
+	std::atomic<IODispatchMode> dispatch_mode;
+	/// What to do when the asynchronous queue is full.
+	IOOverflowPolicy overflow_policy;
+	/// Finished messages waiting for the writer thread.
+	std::unique_ptr<BoundedQueue<Record>> queue;
+	/// The writer thread, which drains the queue in asynchronous mode.
+	std::thread writer;
+	/// Cleared to ask the writer thread to drain the queue and exit.
+	std::atomic<bool> writer_running;
+	/// Raised while the writer thread is waiting for messages.
+	std::atomic<bool> writer_sleeping;
+	/// Used only to put the idle writer thread to sleep.
+	std::mutex writer_lock;
+	std::condition_variable writer_wake;
+	/// Number of queued messages which haven't been dispatched yet.
+	std::atomic<size_t> pending;
+	/// Used only to wake threads in flush() once `pending` reaches zero.
+	std::mutex drained_lock;
+	std::condition_variable drained;
+	/// Number of messages discarded by the overflow policy.
+	std::atomic<size_t> dropped;
+
+	/** Get the calling thread's message builder for this channel,
+	 * creating it if needed.
+	 * \return the builder
+	 */
+	Builder& builder();
 
 	/** Determines whether the verbosity and category match parsing rules.
 	 * \return true if we can definitely parse
@@ -137,16 +244,21 @@ protected:
 			return false;
 		}
 
+		Builder& b = builder();
 		// Inject the formatting flag into the IOFormat
-		this->fmt << val;
+		b.fmt << val;
 		// Require attributes to be reparsed.
-		dirty_attributes = true;
+		b.dirty_attributes = true;
 		// Report processing was successful.
 		return true;
 	}
 
 	/** Flush the standard output. */
-	void flush();
+	void flush_streams();
+
+	/** Flush the standard output once all earlier messages have been
+	 * dispatched, without waiting for that to happen. */
+	void request_flush();
 
 	/** Move the cursor given the command.
 	 * \param rhs: the cursor command
@@ -168,19 +280,74 @@ protected:
 	 * applies unapplied attributes before inserting text.
 	 * \param str: the std::string to insert
 	 */
-	inline void inject(const std::string& str) { inject(str.c_str()); }
+	void inject(const std::string& str);
 
 	/** Transmit the current pending output stream and reset in
 	 * preparation for the next message.
-	 * \param whether to retain the flags
+	 * \param keep: whether to retain the flags
+	 * \param flush: whether to flush the standard output afterwards
 	 */
-	void transmit(bool keep = false);
+	void transmit(bool keep = false, bool flush = false);
+
+	/** Emit a signal and its zero-copy counterpart, skipping either one if
+	 * nothing is connected to it.
+	 * \param signal: the signal taking a std::string
+	 * \param signal_view: the signal taking a std::string_view
+	 * \param msg: the message
+	 * \param args: the remaining arguments (verbosity and/or category)
+	 */
+	template<typename S, typename SV, typename... Args>
+	static void emit(const S& signal,
+					 const SV& signal_view,
+					 const std::string& msg,
+					 Args... args)
+	{
+		if (!signal_view.empty()) {
+			signal_view(std::string_view(msg), args...);
+		}
+		// This one copies the message, so don't call it needlessly.
+		if (!signal.empty()) {
+			signal(msg, args...);
+		}
+	}
+
+	/** Emit the signals and echo for a finished message.
+	 * \param msg: the message to dispatch
+	 * \param msg_vrb: the verbosity of the message
+	 * \param msg_cat: the category of the message
+	 */
+	void dispatch(const std::string& msg, IOVrb msg_vrb, IOCat msg_cat);
+
+	/** Push a finished message onto the asynchronous queue, applying the
+	 * overflow policy if the queue is full.
+	 * \param rec: the message to queue
+	 */
+	void enqueue(Record&& rec);
+
+	/** Wake the writer thread if it is asleep. */
+	void wake_writer();
+
+	/** Count one queued message as dispatched (or discarded), waking any
+	 * threads in flush() if it was the last. */
+	void finish_pending();
 
-	void clear_buffer() { buffer.clear(); }
+	/** The writer thread's main loop: drain the queue until stopped. */
+	void writer_loop();
 
-	/** Injects the current attribute string into the buffer. */
+	/** Drain the queue and stop the writer thread, if it is running. */
+	void stop_writer();
+
+	void clear_buffer() { builder().buffer.clear(); }
+
+	/** Injects the current attribute string into the buffer, or only the
+	 * changes since attributes were last applied in this message. */
 	void inject_attributes();
 
+	/** Record the current attributes as applied in this message.
+	 * \param b: the builder for the message
+	 */
+	static void mark_attributes(Builder& b);
+
 	/** Reset all attributes, and inject the reset attribute string
 	 * into the buffer.*/
 	void reset_attributes();
@@ -190,13 +357,19 @@ protected:
 
 public:
 	Channel()
-	: buffer(""), process_cat(IOCat::all), process_vrb(IOVrb::tmi),
-	  echo_mode(IOEchoMode::cout), echo_cat(IOCat::all), echo_vrb(IOVrb::tmi),
-	  fmt(IOFormat()), vrb(IOVrb::normal), cat(IOCat::normal), parse(maybe),
-	  dirty_attributes(false)
+	: id(next_id.fetch_add(1)), process_cat(IOCat::all),
+	  process_vrb(IOVrb::tmi), generation(1), echo_mode(IOEchoMode::cout),
+	  echo_cat(IOCat::all), echo_vrb(IOVrb::tmi),
+	  dispatch_mode(IODispatchMode::sync),
+	  overflow_policy(IOOverflowPolicy::block), queue(nullptr),
+	  writer_running(false), writer_sleeping(false), pending(0), dropped(0)
 	{
+		enroll();
 	}
 
+	Channel(const Channel&) = delete;
+	Channel& operator=(const Channel&) = delete;
+
 	/// Signal for categories.
 	typedef eventpp::CallbackList<void(std::string, IOCat)> IOSignalCat;
 
@@ -211,6 +384,24 @@ public:
 	 * transmitting only the message. */
 	typedef eventpp::CallbackList<void(std::string)> IOSignalAll;
 
+	/* Zero-copy versions of the signals above. The message is only valid
+	 * until the callback returns, and must be copied to be kept. */
+
+	/// Signal for categories, without copying the message.
+	typedef eventpp::CallbackList<void(std::string_view, IOCat)>
+		IOSignalCatView;
+
+	/// Signal for verbosities, without copying the message.
+	typedef eventpp::CallbackList<void(std::string_view, IOVrb)>
+		IOSignalVrbView;
+
+	/// Signal for everything, without copying the message.
+	typedef eventpp::CallbackList<void(std::string_view, IOVrb, IOCat)>
+		IOSignalFullView;
+
+	/// Signal for only the message, without copying it.
+	typedef eventpp::CallbackList<void(std::string_view)> IOSignalAllView;
+
 	/* NOTE: In the examples below, the verbosity-related signals must
 	 * transmit what category the message is (since verbosity is
 	 * inherent and assumed). The inverse is true of category-related
@@ -282,6 +473,61 @@ public:
 	 */
 	IOSignalAll signal_all;
 
+	/** As signal_v_quiet, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOCat){}'
+	 */
+	IOSignalCatView signal_v_quiet_view;
+
+	/** As signal_v_normal, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOCat){}'
+	 */
+	IOSignalCatView signal_v_normal_view;
+
+	/** As signal_v_chatty, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOCat){}'
+	 */
+	IOSignalCatView signal_v_chatty_view;
+
+	/** As signal_v_tmi, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOCat){}'
+	 */
+	IOSignalCatView signal_v_tmi_view;
+
+	/** As signal_c_normal, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOVrb){}'
+	 */
+	IOSignalVrbView signal_c_normal_view;
+
+	/** As signal_c_warning, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOVrb){}'
+	 */
+	IOSignalVrbView signal_c_warning_view;
+
+	/** As signal_c_error, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOVrb){}'
+	 */
+	IOSignalVrbView signal_c_error_view;
+
+	/** As signal_c_debug, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOVrb){}'
+	 */
+	IOSignalVrbView signal_c_debug_view;
+
+	/** As signal_c_testing, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOVrb){}'
+	 */
+	IOSignalVrbView signal_c_testing_view;
+
+	/** As signal_full, without copying the message.
+	 * Callback must be of form 'void callback(string_view, IOVrb, IOCat){}'
+	 */
+	IOSignalFullView signal_full_view;
+
+	/** As signal_all, without copying the message.
+	 * Callback must be of form 'void callback(string_view){}'
+	 */
+	IOSignalAllView signal_all_view;
+
 	// Process formatting flags.
 	Channel& operator<<(const IOFormatBase& rhs)
 	{
@@ -357,18 +603,20 @@ public:
 	// Set message category.
 	Channel& operator<<(const IOCat& rhs)
 	{
+		Builder& b = builder();
 		// Set the category and force revalidation of parsing.
-		this->cat = rhs;
-		this->parse = maybe;
+		b.cat = rhs;
+		b.parse = maybe;
 		return *this;
 	}
 
 	// Set message verbosity.
 	Channel& operator<<(const IOVrb& rhs)
 	{
+		Builder& b = builder();
 		// Set the verbosity and force the revalidation of parsing.
-		this->vrb = rhs;
-		this->parse = maybe;
+		b.vrb = rhs;
+		b.parse = maybe;
 		return *this;
 	}
 
@@ -393,12 +641,13 @@ public:
 			can_parse() ? inject("\n") : inject("");
 		}
 
-		if (flags_check(rhs, IOCtrl::send)) {
-			transmit(keep);
-		}
+		bool flush = flags_check(rhs, IOCtrl::flush);
 
-		if (flags_check(rhs, IOCtrl::flush)) {
-			flush();
+		// Transmission takes care of flushing after the message is out.
+		if (flags_check(rhs, IOCtrl::send)) {
+			transmit(keep, flush);
+		} else if (flush) {
+			request_flush();
 		}
 
 		return *this;
@@ -423,7 +672,7 @@ public:
 			return *this;
 		}
 
-		inject(rhs.c_str());
+		inject(rhs);
 
 		return *this;
 	}
@@ -436,11 +685,32 @@ public:
 			return *this;
 		}
 
-		inject(stringify(rhs, this->fmt));
+		// Stringify straight into the message, without a temporary string.
+		inject_attributes();
+		Builder& b = builder();
+		stringify_to(b.buffer, rhs, b.fmt);
 
 		return *this;
 	}
 
+	/** Determine whether a message of the given verbosity and category
+	 * would be broadcast, without starting one.
+	 * \param vrb: the verbosity of the message
+	 * \param cat: the category of the message
+	 * \return true if the message would be broadcast
+	 */
+	bool will_parse(const IOVrb& vrb, const IOCat& cat) const
+	{
+		return vrb <= process_vrb.load(std::memory_order_relaxed) &&
+			   flags_check(process_cat.load(std::memory_order_relaxed), cat);
+	}
+
+	/** Get the formatting of the message the calling thread is composing
+	 * on this channel.
+	 * \return the current formatting flags
+	 */
+	const IOFormat& get_format() { return builder().fmt; }
+
 	/** Configure if/when channel echoes to the standard output.
 	 * \param mode: the echo mode (typically cout or fstream)
 	 * \param vrb: the maximum verbosity to echo.
@@ -450,6 +720,35 @@ public:
 						IOVrb vrb = IOVrb::tmi,
 						IOCat cat = IOCat::all);
 
+	/// \return the echo mode set by configure_echo()
+	IOEchoMode get_echo_mode() const { return echo_mode; }
+
+	/// \return the maximum verbosity to echo
+	IOVrb get_echo_vrb() const { return echo_vrb; }
+
+	/// \return the categories to echo
+	IOCat get_echo_cat() const { return echo_cat; }
+
+	/** Configure whether signals and echo are dispatched on the
+	 * transmitting thread, or asynchronously on a dedicated writer thread.
+	 * CAUTION: Do not call while other threads are transmitting.
+	 * \param mode: the dispatch mode
+	 * \param capacity: the maximum number of queued messages (async only)
+	 * \param policy: what to do when the queue is full (async only)
+	 */
+	void configure_dispatch(
+		IODispatchMode mode,
+		size_t capacity = 1024,
+		IOOverflowPolicy policy = IOOverflowPolicy::block);
+
+	/** Wait until every transmitted message has been dispatched,
+	 * then flush the standard output.
+	 */
+	void flush();
+
+	/// \return the number of messages discarded by the overflow policy
+	size_t dropped_messages() const { return dropped.load(); }
+
 	/** Suppress a category from broadcasting at all.
 	 * \param the category to suppress
 	 */
@@ -477,10 +776,32 @@ public:
 	 */
 	void speak_up();
 
-	~Channel() = default;
+	~Channel()
+	{
+		stop_writer();
+		withdraw();
+	}
 };
 
-/// Global instance of Channel.
-static inline Channel channel = Channel();
+/// Global instance of Channel, shared by the whole program.
+inline Channel channel = Channel();
+
+/** Start a message with the given verbosity and category, which is only
+ * evaluated if it will be broadcast. The rest of the message follows:
+ *
+ *     CHANNEL_LOG(channel, IOVrb::tmi, IOCat::debug) << expensive() << IOCtrl::endl;
+ *
+ * If the verbosity and category are filtered out at compile time (see
+ * io_compiled_in()), the whole statement compiles to nothing. Otherwise,
+ * if they are filtered out at runtime, none of the operands are evaluated.
+ * \param chan: the Channel to send to
+ * \param vrb: the verbosity of the message (must be a constant)
+ * \param cat: the category of the message (must be a constant)
+ */
+#define CHANNEL_LOG(chan, vrb, cat)                                           \
+	if constexpr (!io_compiled_in(vrb, cat)) {                                \
+	} else if (!(chan).will_parse(vrb, cat)) {                                \
+	} else                                                                    \
+		(chan) << (vrb) << (cat)
 
 #endif
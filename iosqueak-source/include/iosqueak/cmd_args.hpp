@@ -0,0 +1,154 @@
+#ifndef CMD_ARGS_HPP
+#define CMD_ARGS_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What an argument in a Cmd_schema is parsed as.
+enum class Cmd_arg_type {
+	// A whole number, such as -12, which must fit in a long long.
+	integer,
+	/* A finite decimal number, such as 2.5, .5 or 1e3, always with '.' as
+	 * the decimal point. Hexadecimal, infinity and NaN aren't accepted. */
+	real,
+	// true/false, yes/no, on/off or 1/0.
+	boolean,
+	// One of a list of words. Parsed as its position in the list.
+	choice,
+	// Any word, as it was typed.
+	text
+};
+
+class Cmd_schema;
+
+/* The arguments sent to a command with a schema, already checked and
+ * parsed. Positional arguments are looked up by their position, in the
+ * order they were declared. */
+class Cmd_args
+{
+	friend class Cmd_schema;
+
+	struct value {
+		Cmd_arg_type type;
+		union {
+			long long integer;
+			double real;
+			bool boolean;
+			// The choice, or the index of the text in 'texts'.
+			size_t index;
+		};
+	};
+
+	const Cmd_schema* schema{nullptr};
+	std::vector<value> values;
+	std::vector<std::string> texts;
+	std::vector<std::string> rest_words;
+	// Which flags were given, one bit per flag in the order declared.
+	uint64_t flags{0};
+
+public:
+	// Returns the number of positional arguments.
+	size_t size() const { return values.size(); }
+
+	long long integer(size_t i) const
+	{
+		assert(values[i].type == Cmd_arg_type::integer);
+		return values[i].integer;
+	}
+
+	double real(size_t i) const
+	{
+		assert(values[i].type == Cmd_arg_type::real);
+		return values[i].real;
+	}
+
+	bool boolean(size_t i) const
+	{
+		assert(values[i].type == Cmd_arg_type::boolean);
+		return values[i].boolean;
+	}
+
+	// Returns the position of the word chosen in the list of choices.
+	size_t choice(size_t i) const
+	{
+		assert(values[i].type == Cmd_arg_type::choice);
+		return values[i].index;
+	}
+
+	const std::string& text(size_t i) const
+	{
+		assert(values[i].type == Cmd_arg_type::text);
+		return texts[values[i].index];
+	}
+
+	// Check if a flag (declared without its "--") was given.
+	bool flag(std::string_view name) const;
+
+	// The words collected by a variadic argument.
+	const std::vector<std::string>& rest() const { return rest_words; }
+};
+
+/* The arguments a command takes, declared when it is registered, so the
+ * shell can check and parse them once before the command runs. Positional
+ * arguments must be given in the order they are declared. Flags are given
+ * as "--name" anywhere among them, until a "--" word. A variadic argument
+ * collects any words after the positional arguments. For example:
+ *
+ *     Cmd_schema().integer("count").choice("mode", {"fast", "slow"})
+ *         .flag("force").variadic("files")
+ */
+class Cmd_schema
+{
+	struct arg {
+		std::string name;
+		Cmd_arg_type type;
+		std::vector<std::string> choices;
+	};
+
+	std::vector<arg> positional;
+	std::vector<std::string> flag_names;
+	// The name of the variadic argument, if there is one.
+	std::string rest_name;
+	bool has_rest{false};
+
+	Cmd_schema& add(std::string, Cmd_arg_type, std::vector<std::string> = {});
+
+	// Parse a word as the given positional argument.
+	bool parse_value(const arg&, std::string_view, Cmd_args&, std::string&)
+		const;
+
+	friend class Cmd_args;
+
+public:
+	// The most flags a schema can have.
+	static constexpr size_t max_flags = 64;
+
+	Cmd_schema& integer(std::string name);
+	Cmd_schema& real(std::string name);
+	Cmd_schema& boolean(std::string name);
+	Cmd_schema& choice(std::string name, std::vector<std::string> choices);
+	Cmd_schema& text(std::string name);
+	Cmd_schema& flag(std::string name);
+	Cmd_schema& variadic(std::string name);
+
+	// Returns the number of positional arguments.
+	size_t size() const { return positional.size(); }
+
+	/* Describe the arguments, such as
+	 * "<count:int> <mode:fast|slow> [--force] [files...]". */
+	std::string usage() const;
+
+	/* Check and parse the words sent to a command (not including its
+	 * name) into 'args'. If they don't fit, returns false and describes
+	 * why in 'error'. */
+	bool parse(const std::string_view* words,
+			   size_t count,
+			   Cmd_args& args,
+			   std::string& error) const;
+};
+
+#endif  // CMD_ARGS_HPP
@@ -0,0 +1,179 @@
+#ifndef CMD_HISTORY_HPP
+#define CMD_HISTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "iosqueak/cmd_tokenizer.hpp"
+
+/* The history of commands entered into a shell. Every command gets the next
+ * history number. The most recent commands are kept in a fixed-size ring, so
+ * finding one by its number is O(1), and they are indexed by their first
+ * word. The history can also be kept in an append-only log file, one
+ * "<number> <command>" line per command, which is memory-mapped when opened
+ * so that only its end needs to be read. A command containing a newline
+ * is written as "<number>\t<command>" instead, with each newline written
+ * as "\n" and each backslash as "\\". */
+class Cmd_history
+{
+public:
+	// A history number and its command.
+	using entry = std::pair<size_t, std::string>;
+
+private:
+	// The remembered commands. Number n is at (n - 1) % ring.size().
+	std::vector<entry> ring;
+	// Which characters each remembered command contains (see char_mask()).
+	std::vector<uint64_t> masks;
+	// How many commands are remembered.
+	size_t count{0};
+	// The number of the most recent command, or 0 if none.
+	size_t last{0};
+
+	// Hashes first words, so they can be looked up without a std::string.
+	struct word_hash {
+		using is_transparent = void;
+		size_t operator()(std::string_view word) const noexcept
+		{
+			return std::hash<std::string_view>{}(word);
+		}
+	};
+
+	// The numbers of remembered commands, oldest first, by first word.
+	std::unordered_map<std::string,
+					   std::deque<size_t>,
+					   word_hash,
+					   std::equal_to<>>
+		first_words;
+
+	// The log file, or -1 if there isn't one.
+	int fd{-1};
+	// The log file's contents when it was last mapped.
+	mutable const char* mapped{nullptr};
+	mutable size_t mapped_size{0};
+	/* Earlier mappings of the log file. Commands found in them may still be
+	 * in use, so they are kept until the file is closed. */
+	mutable std::vector<std::pair<const char*, size_t>> retired;
+	// Escaped commands found in the log file, decoded, by number.
+	mutable std::unordered_map<size_t, std::string> decoded;
+
+	/* Where the log file's last run of increasing numbers (the one the
+	 * remembered commands belong to) starts, and the number there. Only
+	 * that run is searched. It is found from the end when the file is
+	 * opened, and only walked back further if a search needs it. */
+	mutable size_t run_start{0};
+	mutable size_t run_first{0};
+	mutable bool run_complete{true};
+
+	// Finds the first word of a command, the same way the shell does.
+	Cmd_tokenizer words;
+
+	/* Parse a "<number> <command>" log line into its command, and whether
+	 * the command is escaped. Returns the number, or 0 if the line is
+	 * malformed. */
+	static size_t parse_line(std::string_view, std::string_view&, bool&);
+
+	// Write a command to a log line, escaping it if it contains a newline.
+	static void format_line(std::string&, size_t, std::string_view);
+
+	// Decode an escaped command from a log line.
+	static void unescape(std::string&, std::string_view);
+
+	/* Map (or re-map) the whole log file into memory. An earlier mapping
+	 * is retired, not unmapped. */
+	void map_file() const;
+	void unmap_file() const;
+
+	// Walk the start of the last run back to the first line of that run.
+	void find_run_start() const;
+
+	/* Remember a command, forgetting the oldest one if the ring is full.
+	 * The number must follow the last one remembered. */
+	void remember(size_t, std::string_view);
+
+	// Forget all remembered commands.
+	void forget();
+
+	/* Binary search the last run of the mapped log file for a command by
+	 * its number. */
+	std::optional<std::string_view> search_file(size_t) const;
+
+public:
+	// Remember up to 'capacity' of the most recent commands.
+	explicit Cmd_history(size_t capacity = 10000);
+	Cmd_history(const Cmd_history&) = delete;
+	Cmd_history& operator=(const Cmd_history&) = delete;
+
+	/* Open (or create) a log file to keep the history in, replacing what
+	 * is remembered with the most recent commands from it. If the numbers
+	 * at its end aren't consecutive, only the last consecutive run is
+	 * remembered. Later commands are appended to it. Returns false if it
+	 * couldn't be opened. */
+	bool open(const std::string& path);
+
+	// Stop adding to the log file. What is remembered is kept.
+	void close();
+
+	// Add a command to the history. Returns its history number.
+	size_t add(std::string_view command);
+
+	/* Find a command by its history number. Commands no longer remembered
+	 * are looked up in the log file, if there is one, but only in its last
+	 * run of increasing numbers, which the remembered commands belong to.
+	 * The command stays valid until it is forgotten or the log is closed. */
+	std::optional<std::string_view> find(size_t number) const;
+
+	/* Returns the numbers of the remembered commands whose first word is
+	 * 'word', oldest first, or nullptr if there are none. */
+	const std::deque<size_t>* starting_with(std::string_view word) const;
+
+	/* Returns a bitmask of the characters in the text, ignoring case.
+	 * If text contains all of the characters in a query, the query's mask
+	 * is a subset of the text's mask, which makes for a fast filter. */
+	static uint64_t char_mask(std::string_view text);
+
+	/* Score how well the query matches the text as a subsequence, ignoring
+	 * case. Consecutive characters, characters at the start of a word, and
+	 * matches at the start of the text score higher, and gaps score lower.
+	 * Returns -1 if the query isn't a subsequence of the text. */
+	static int fuzzy_score(std::string_view query, std::string_view text);
+
+	/* Returns the character mask of a remembered command, by its history
+	 * number. */
+	uint64_t mask(size_t number) const
+	{
+		return masks[(number - 1) % masks.size()];
+	}
+
+	// Returns the i-th most recent command (0 is the most recent).
+	const entry& operator[](size_t i) const
+	{
+		return ring[(last - 1 - i) % ring.size()];
+	}
+
+	// Returns the most recent command.
+	const entry& front() const { return (*this)[0]; }
+
+	// Returns the number of the oldest remembered command.
+	size_t oldest() const { return last - count + 1; }
+
+	// Returns the number of the most recent command, or 0 if none.
+	size_t newest() const { return last; }
+
+	// Returns how many commands are remembered.
+	size_t size() const { return count; }
+
+	bool empty() const { return count == 0; }
+
+	~Cmd_history() { close(); }
+};
+
+#endif  // CMD_HISTORY_HPP
@@ -0,0 +1,110 @@
+#ifndef CMD_JOBS_HPP
+#define CMD_JOBS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Runs commands in the background on a pool of worker threads, so the
+ * shell can keep taking input. Every job gets the next job number, and is
+ * kept until it is waited for, or listed after it finished. Jobs can be
+ * cancelled: queued jobs never start, and running ones can check
+ * cancel_requested() and stop early. */
+class Cmd_jobs
+{
+public:
+	enum class job_state { queued, running, done, cancelled };
+
+	// The status of a job whose command threw an exception.
+	static constexpr int threw = -1;
+
+	// A job, as it was when it was looked up.
+	struct job {
+		size_t id;
+		std::string command;
+		job_state state;
+		// What the command returned, once it is done.
+		int status;
+	};
+
+private:
+	struct record {
+		job info;
+		std::function<int()> work;
+		std::atomic<bool> cancel{false};
+	};
+
+	// Called on the worker thread when a job finishes.
+	std::function<void(const job&)> finished;
+
+	size_t threads;
+	std::vector<std::thread> workers;
+
+	mutable std::mutex lock;
+	// Signalled when a job is queued, or the workers should stop.
+	std::condition_variable work_ready;
+	// Signalled when a job finishes.
+	std::condition_variable work_done;
+
+	std::map<size_t, std::shared_ptr<record>> table;
+	std::deque<std::shared_ptr<record>> pending;
+	size_t next_id{1};
+	bool stopping{false};
+
+	// The job running on this thread, if any.
+	static thread_local record* current;
+
+	void worker_loop();
+
+	static bool is_finished(const record&);
+
+public:
+	/* Run up to 'thread_count' jobs at once. If 0, one per hardware
+	 * thread, but at least 4. Threads are only started as jobs need them. */
+	explicit Cmd_jobs(size_t thread_count = 0);
+	Cmd_jobs(const Cmd_jobs&) = delete;
+	Cmd_jobs& operator=(const Cmd_jobs&) = delete;
+
+	// Set what to call (on the worker thread) when a job finishes.
+	void on_finish(std::function<void(const job&)> callback);
+
+	// Queue a job. Returns its job number.
+	size_t start(std::string command, std::function<int()> work);
+
+	// Returns all the jobs being kept, in order.
+	std::vector<job> list() const;
+
+	// Stop keeping the jobs that are done or cancelled.
+	void forget_finished();
+
+	/* Wait for a job to finish, and stop keeping it. Returns it, or
+	 * nothing if there is no such job. A job can't wait for itself, so
+	 * that also returns nothing. A job waiting for another one which is
+	 * still queued waits for a free thread, so with every thread doing
+	 * the same, they would wait forever. */
+	std::optional<job> wait(size_t id);
+
+	/* Cancel a job. Returns false if there is no such job, or it
+	 * already finished. */
+	bool cancel(size_t id);
+
+	/* Whether the job running on this thread was cancelled. Long-running
+	 * commands can check this to stop early. */
+	static bool cancel_requested();
+
+	// Cancel the queued jobs, ask running ones to stop, and wait for them.
+	void stop();
+
+	~Cmd_jobs();
+};
+
+#endif  // CMD_JOBS_HPP
@@ -3,14 +3,22 @@
 
 #include <algorithm>
 #include <deque>
+#include <functional>
 #include <iostream>
-#include <unordered_set>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "iosqueak/cmd_args.hpp"
+#include "iosqueak/cmd_trie.hpp"
 using _register = std::function<int(std::deque<std::string>&)>;
+// For commands with a schema, which get their arguments already parsed.
+using _typed_register = std::function<int(const Cmd_args&)>;
 
-/* Struct for the members needed in Cmd_map. Thanks to
- * Alipha from C++ basics for showing me how to fix
- * the error having a nested struct and creating
- * a hash for unordered_set issue. */
+// Struct for the members needed in Cmd_map.
 namespace details
 {
 struct func_info {
@@ -19,7 +27,11 @@ struct func_info {
 	std::string short_desc = "nodesc";
 	std::string long_desc = "nodesc";
 
-	size_t number_of_args;
+	size_t number_of_args = 0;
+
+	// Set instead of func_command for commands with a schema.
+	_typed_register typed_command;
+	Cmd_schema schema;
 
 	friend bool operator==(const func_info& first, const func_info& second)
 	{
@@ -28,35 +40,29 @@ struct func_info {
 };
 }  // namespace details
 
-// Creates a hash for func_info.
-namespace std
-{
-template<> struct hash<details::func_info> {
-	std::size_t operator()(details::func_info const& s) const noexcept
-	{
-		std::size_t first{std::hash<std::string>{}(s.func_name)};
-		std::size_t second{std::hash<std::string>{}(s.short_desc)};
-		return first ^ (second << 1);
-	}
-};
-}  // namespace std
-
 class Cmd_map
 {
 private:
 	using func_info = details::func_info;
-	using func_set = std::unordered_set<func_info>;
+	/* Keyed on a view of each command's own name, so lookups can be
+	 * done with a std::string_view without building a std::string. The
+	 * func_info is held by pointer so the name never moves. */
+	using func_map =
+		std::unordered_map<std::string_view, std::unique_ptr<func_info>>;
 
-	/* unordered_set to store a collection of
+	/* unordered_map to store a collection of
 	 * commands with the help descriptions. */
-	func_set commands;
+	func_map commands;
+
+	// The same command names, for completing partial names.
+	Cmd_trie names;
 
 public:
-	bool find_match(const std::string&);
+	bool find_match(std::string_view) const;
 
 	/* Check if number of arguments sent match the
 	 * number of arguments required. */
-	bool match_args(const std::string&, size_t);
+	bool match_args(std::string_view, size_t) const;
 
 	void add_command(const std::string&,
 					 _register&,
@@ -64,9 +70,27 @@ public:
 					 const std::string&,
 					 size_t);
 
-	/* Return a container of func_info struct
-	 * to access the members. */
-	func_info send_element(const std::string&);
+	// Add a command whose arguments are checked and parsed by its schema.
+	void add_command(const std::string&,
+					 _typed_register&,
+					 Cmd_schema,
+					 const std::string&,
+					 const std::string&);
+
+	/* Return the command with the given name,
+	 * or nullptr if there isn't one. */
+	const func_info* find(std::string_view) const;
+
+	/* Return the func_info struct to access the members. If there
+	 * is no such command, its func_name is "noname". */
+	const func_info& send_element(std::string_view) const;
+
+	/* Return all commands starting with the prefix, in sorted
+	 * order, and the longest prefix they all share. */
+	Cmd_trie::completion complete(std::string_view prefix) const
+	{
+		return names.complete(prefix);
+	}
 
 	/* Function to send all short descriptions of the
 	 * commands available. */
@@ -78,7 +102,7 @@ public:
 
 	/* Function to return reference to 'commands' for
 	 * lookups. */
-	const func_set& get_set() { return commands; }
+	const func_map& get_map() const { return commands; }
 };
 
 #endif  // CMD_MAP_HPP
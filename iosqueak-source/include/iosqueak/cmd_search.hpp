@@ -0,0 +1,72 @@
+#ifndef CMD_SEARCH_HPP
+#define CMD_SEARCH_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "iosqueak/cmd_history.hpp"
+
+/* A search of the remembered commands of a history as the query is typed,
+ * as for Ctrl-R. Matches don't need to be contiguous, and are ranked by
+ * Cmd_history::fuzzy_score(), then by recency, skipping repeats of the
+ * same command. Only the commands in the history's ring are searched, not
+ * the rest of its log file. The history must not change during a search. */
+class Cmd_search
+{
+	// A match's score and history number.
+	using scored = std::pair<int, size_t>;
+
+	const Cmd_history& history;
+	std::string text;
+
+	/* The matches for each length of query, with the scores they got while
+	 * narrowing. Each level only needs to check the previous one's matches,
+	 * and going back a character just drops the last level. The current
+	 * level is sorted into rank order as far as it has been shown. */
+	std::vector<std::vector<scored>> levels;
+	size_t sorted{0};
+
+	// Which match of the current level is shown, and the commands before it.
+	size_t shown{0};
+	std::unordered_set<std::string_view> seen;
+	std::string_view current;
+	bool matched{false};
+
+	// Start showing the current level's matches from the best one.
+	void restart();
+
+	// Find the next distinct match from 'shown' on, sorting as we go.
+	bool next_match();
+
+public:
+	explicit Cmd_search(const Cmd_history& history);
+	Cmd_search(const Cmd_search&) = delete;
+	Cmd_search& operator=(const Cmd_search&) = delete;
+
+	// Add a character to the query, and show the best match.
+	void push(char ch);
+
+	// Remove the last character of the query, and show the best match.
+	void pop();
+
+	/* Show the next best match. Returns false, still showing the same
+	 * match, if there isn't one. */
+	bool next();
+
+	// Returns the query typed so far.
+	const std::string& query() const { return text; }
+
+	// Returns whether a match is shown. Nothing matches an empty query.
+	bool found() const { return matched; }
+
+	// Returns the match shown, if found().
+	std::string_view match() const { return current; }
+
+	~Cmd_search() = default;
+};
+
+#endif  // CMD_SEARCH_HPP
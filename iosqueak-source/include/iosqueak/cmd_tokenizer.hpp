@@ -0,0 +1,39 @@
+#ifndef CMD_TOKENIZER_HPP
+#define CMD_TOKENIZER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Splits a command line into words in a single pass. Words are separated by
+ * whitespace. Text in "double" or 'single' quotes is kept in one word, and
+ * inside quotes, \", \' and \\ stand for the character after the backslash.
+ * Words are views into the line, except for words with escapes or with
+ * quotes that aren't around the whole word. Those are unquoted into the
+ * tokenizer's own buffer, which is reused from line to line. */
+class Cmd_tokenizer
+{
+public:
+	using tokens = std::vector<std::string_view>;
+
+private:
+	tokens words;
+
+	// The words that had to be unquoted.
+	std::string storage;
+
+	// Split up to 'limit' words from the line.
+	void scan(std::string_view, size_t limit);
+
+public:
+	/* Split a line into words. The words view both the line and the
+	 * tokenizer, so they are only valid until either is changed. */
+	const tokens& split(std::string_view line);
+
+	/* Find just the first word of a line, or an empty view if there are no
+	 * words. This replaces the words from the last split(). */
+	std::string_view first(std::string_view line);
+};
+
+#endif  // CMD_TOKENIZER_HPP
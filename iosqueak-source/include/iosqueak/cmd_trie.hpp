@@ -0,0 +1,61 @@
+#ifndef CMD_TRIE_HPP
+#define CMD_TRIE_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* A compressed prefix trie (radix tree) of command names, used for tab
+ * completion. Each edge holds a run of characters, so finding the commands
+ * starting with a prefix takes time proportional to the prefix, plus the
+ * number of matches collected. */
+class Cmd_trie
+{
+public:
+	// The result of completing a prefix.
+	struct completion {
+		// All matching names, in sorted order.
+		std::vector<std::string> matches;
+		// The longest prefix shared by every match.
+		std::string common;
+	};
+
+private:
+	struct node {
+		// The characters on the edge leading to this node.
+		std::string label;
+		// Whether a name ends at this node.
+		bool terminal{false};
+		// Children, sorted by the first character of their labels.
+		std::vector<std::unique_ptr<node>> children;
+	};
+
+	node root;
+	size_t count{0};
+
+	/* Find the child whose label starts with the given character,
+	 * or the position it should be inserted at. */
+	static std::vector<std::unique_ptr<node>>::iterator
+	find_child(node&, char);
+	static std::vector<std::unique_ptr<node>>::const_iterator
+	find_child(const node&, char);
+
+	// Add every name in the subtree, in sorted order.
+	static void collect(const node&, std::string&, std::vector<std::string>&);
+
+public:
+	// Add a name to the trie. Adding a name twice has no effect.
+	void insert(std::string_view);
+
+	// Check if the exact name is in the trie.
+	bool contains(std::string_view) const;
+
+	// Find all names starting with the prefix, and their common prefix.
+	completion complete(std::string_view) const;
+
+	// Returns the number of names in the trie.
+	size_t size() const { return count; }
+};
+
+#endif  // CMD_TRIE_HPP
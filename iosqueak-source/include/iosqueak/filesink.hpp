@@ -0,0 +1,218 @@
+/** FileSink [IOSqueak]
+ * Version: 1.0
+ *
+ * Writes a Channel's messages to a file. Messages are collected in large,
+ * aligned buffers and written out in batches with a single `writev()`, and
+ * the file can be rotated by size and by age.
+ *
+ * Author: Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_FILESINK_HPP
+#define IOSQUEAK_FILESINK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "iosqueak/channel.hpp"
+#include "iosqueak/ioctrl.hpp"
+
+class FileSink
+{
+protected:
+	/// A single aligned, fixed-size buffer.
+	struct Block {
+		char* data = nullptr;
+		size_t used = 0;
+	};
+
+	// Avoiding magic numbers (typical page size, for aligned allocation).
+	static constexpr size_t ALIGNMENT = 4096;
+
+	/// The path of the active file.
+	const std::string path;
+	/// The active file descriptor, or -1 if closed.
+	int fd;
+
+	/// The buffers. Filled in order; all are written in one batch.
+	std::vector<Block> blocks;
+	/// The size of each buffer.
+	size_t block_size;
+	/// The buffer currently being filled.
+	size_t current;
+
+	/// The maximum verbosity to write.
+	IOVrb filter_vrb;
+	/// The categories to write.
+	IOCat filter_cat;
+
+	/// The size at which to rotate the file (0 to never rotate by size).
+	size_t max_bytes;
+	/// The age at which to rotate the file (0 to never rotate by age).
+	std::chrono::seconds max_age;
+	/// How many rotated files to keep (path.1 through path.N).
+	unsigned int keep;
+	/// When to force data onto the storage device.
+	IOSyncPolicy sync_policy;
+	/// The longest buffered data may wait before a message writes it out.
+	std::chrono::milliseconds max_delay;
+
+	/// Bytes actually written to the active file, not counting buffers.
+	size_t file_bytes;
+	/// When the active file was opened.
+	std::chrono::steady_clock::time_point opened;
+	/// When the buffers were last written out.
+	std::chrono::steady_clock::time_point last_write;
+	/// The most recent error from writing, or 0.
+	int error;
+
+	/// Protects everything above from concurrent messages.
+	mutable std::mutex lock;
+
+	/// The channel we are attached to, if any.
+	Channel* attached;
+	/// Our callback on that channel.
+	Channel::IOSignalFullView::Handle handle;
+
+	/** Open (or create) the active file for appending.
+	 * \return true if opened, else false (and `error` is set)
+	 */
+	bool open_file();
+
+	/** Sync (if requested) and close the active file. */
+	void close_file();
+
+	/** Close the active file, shift the rotated files down, and start
+	 * a new active file. */
+	void rotate();
+
+	/** Write out all buffered data, plus an optional extra message,
+	 * in a single `writev()` where possible.
+	 * \param extra: data to write after the buffers, or nullptr
+	 * \param extra_len: the length of the extra data
+	 */
+	void write_out(const char* extra = nullptr, size_t extra_len = 0);
+
+	/// \return the number of bytes currently buffered
+	size_t buffered() const;
+
+	/** Copy a message into the buffers. The caller must ensure it fits.
+	 * \param msg: the message data
+	 * \param len: the length of the message
+	 */
+	void buffer(const char* msg, size_t len);
+
+public:
+	/** Open a file sink.
+	 * Throws std::system_error if the file cannot be opened.
+	 * \param file: the path of the file to append to
+	 * \param vrb: the maximum verbosity to write
+	 * \param cat: the categories to write
+	 * \param buffer_size: the size of each buffer, rounded up to 4 KiB
+	 * \param buffer_count: the number of buffers to batch into one write
+	 */
+	explicit FileSink(const std::string& file,
+					  IOVrb vrb = IOVrb::tmi,
+					  IOCat cat = IOCat::all,
+					  size_t buffer_size = 64 * 1024,
+					  size_t buffer_count = 4);
+
+	FileSink(const FileSink&) = delete;
+	FileSink& operator=(const FileSink&) = delete;
+
+	/** Configure which messages are written, in the same manner as
+	 * Channel::configure_echo().
+	 * \param vrb: the maximum verbosity to write
+	 * \param cat: the categories to write
+	 */
+	void configure_filter(IOVrb vrb = IOVrb::tmi, IOCat cat = IOCat::all);
+
+	/** Configure when the file is rotated. The active file is renamed to
+	 * `file.1`, the previous `file.1` to `file.2`, and so forth.
+	 * \param bytes: the size to rotate at (0 to never rotate by size)
+	 * \param age: the age to rotate at (0 to never rotate by age)
+	 * \param files: the number of rotated files to keep
+	 */
+	void configure_rotation(size_t bytes,
+							std::chrono::seconds age = std::chrono::seconds(0),
+							unsigned int files = 5);
+
+	/** Configure when data is forced onto the storage device.
+	 * \param policy: the sync policy
+	 */
+	void configure_sync(IOSyncPolicy policy);
+
+	/** Configure how long buffered data may wait before being written out.
+	 * This is only checked when a message arrives; nothing writes out on a
+	 * timer, so once the channel goes quiet, buffered data waits for the
+	 * next message or for flush(). Call flush() periodically, or before
+	 * anything which needs the file to be complete.
+	 * \param delay: the maximum delay (0 to write every message immediately)
+	 */
+	void configure_delay(std::chrono::milliseconds delay);
+
+	/** Start writing a channel's messages. Detaches from any other channel.
+	 * \param chan: the channel to attach to
+	 */
+	void attach(Channel& chan = ::channel);
+
+	/** Stop writing a channel's messages. Buffered data is not flushed. */
+	void detach();
+
+	/** Write a single message, if it passes the filter.
+	 * This is the callback attached to the channel.
+	 * \param msg: the message
+	 * \param vrb: the verbosity of the message
+	 * \param cat: the category of the message
+	 */
+	void write(std::string_view msg, IOVrb vrb, IOCat cat);
+
+	/** Write out all buffered data. */
+	void flush();
+
+	/// \return the most recent error (an errno value) from writing, or 0
+	int last_error() const;
+
+	~FileSink();
+};
+
+#endif
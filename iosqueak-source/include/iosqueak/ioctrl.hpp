@@ -118,6 +118,35 @@ enum class IOEchoMode {
 	// TODO: Expand to allow turning on/off ONLY cerr or ONLY cout, etc.
 };
 
+/// Controls which thread a channel's signals and echo are dispatched on.
+enum class IODispatchMode {
+	/// Dispatch on the transmitting thread, before transmission returns.
+	sync = 0,
+	/** Queue the finished message and dispatch on a dedicated writer thread,
+	 * so transmission never waits on callbacks or slow outputs. */
+	async = 1
+};
+
+/// What an asynchronous channel does when its message queue is full.
+enum class IOOverflowPolicy {
+	/// Wait for the writer thread to make room. No messages are lost.
+	block = 0,
+	/// Discard the message being transmitted.
+	drop_newest = 1,
+	/// Discard the oldest queued message to make room.
+	drop_oldest = 2
+};
+
+/// When a FileSink forces its data onto the storage device.
+enum class IOSyncPolicy {
+	/// Leave it to the operating system.
+	none = 0,
+	/// Sync before the file is rotated or closed.
+	on_close = 1,
+	/// Sync after every batch of writes.
+	on_write = 2
+};
+
 /**Indicate how many bytes to read from any pointer that isn't
  * recognized explicitly by channel, including void pointers.
  * This will NOT override the memory dump read size of existing types.
@@ -147,4 +176,30 @@ enum class IOVrb {
 	tmi = 3
 };
 
+/* Compile-time message filtering. To strip messages out of a build
+ * entirely, define these before including IOSqueak (such as with
+ * `-DIOSQUEAK_VRB_MAX=1`) and send messages with CHANNEL_LOG(). */
+
+#ifndef IOSQUEAK_VRB_MAX
+/// The highest verbosity (as an IOVrb value) compiled into the program.
+#define IOSQUEAK_VRB_MAX 3
+#endif
+
+#ifndef IOSQUEAK_CAT_MASK
+/// The categories (as IOCat bits) compiled into the program.
+#define IOSQUEAK_CAT_MASK 31
+#endif
+
+/** Determine whether messages of the given verbosity and category are
+ * compiled in, per IOSQUEAK_VRB_MAX and IOSQUEAK_CAT_MASK.
+ * \param vrb: the verbosity of the message
+ * \param cat: the category of the message
+ * \return true if the message is compiled in
+ */
+constexpr bool io_compiled_in(IOVrb vrb, IOCat cat)
+{
+	return static_cast<int>(vrb) <= IOSQUEAK_VRB_MAX &&
+		   (static_cast<int>(cat) & IOSQUEAK_CAT_MASK) != 0;
+}
+
 #endif
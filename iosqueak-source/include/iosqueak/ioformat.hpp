@@ -129,7 +129,11 @@ enum class IOFormatCharValue { as_char = 0, as_int = 1 };
 
 /// Defines how many decimal places should be shown in a floating-point number.
 struct IOFormatDecimalPlaces {
-	explicit IOFormatDecimalPlaces(unsigned int p) : places(p) {}
+	/** Show only as many digits as are needed to read back the exact same
+	 * value (shortest round-trip), instead of a fixed number of places. */
+	static constexpr int shortest = -1;
+
+	explicit IOFormatDecimalPlaces(int p) : places(p) {}
 
 	int places = 14;
 };
@@ -268,6 +272,11 @@ private:
 	IOFormatTextBG fmt_text_bg;
 	IOFormatTextFG fmt_text_fg;
 
+	/// The format string for the current attributes and standard.
+	mutable std::string fmt_format_string;
+	/// Raised when the attributes or standard change, to regenerate the above.
+	mutable bool fmt_format_dirty;
+
 public:
 	/// Default constructor
 	IOFormat()
@@ -281,7 +290,8 @@ public:
 	  fmt_sci_notation(IOFormatSciNotation::automatic),
 	  fmt_sign(IOFormatSign::automatic), fmt_standard(IOFormatStandard::ansi),
 	  fmt_text_attr(IOFormatTextAttr::none), fmt_text_bg(IOFormatTextBG::none),
-	  fmt_text_fg(IOFormatTextFG::none)
+	  fmt_text_fg(IOFormatTextFG::none), fmt_format_string(),
+	  fmt_format_dirty(true)
 	{
 	}
 
@@ -293,7 +303,9 @@ public:
 	  fmt_numeral_case(cpy.fmt_numeral_case), fmt_ptr(cpy.fmt_ptr),
 	  fmt_sci_notation(cpy.fmt_sci_notation), fmt_sign(cpy.fmt_sign),
 	  fmt_standard(cpy.fmt_standard), fmt_text_attr(cpy.fmt_text_attr),
-	  fmt_text_bg(cpy.fmt_text_bg), fmt_text_fg(cpy.fmt_text_fg)
+	  fmt_text_bg(cpy.fmt_text_bg), fmt_text_fg(cpy.fmt_text_fg),
+	  fmt_format_string(cpy.fmt_format_string),
+	  fmt_format_dirty(cpy.fmt_format_dirty)
 	{
 	}
 
@@ -370,14 +382,39 @@ public:
 	 */
 	const std::string format_string(const IOFormatStandard& standard) const;
 
-	/** Generate a terminal format string (e.g. ANSI SGR) for the current
+	/** Get the terminal format string (e.g. ANSI SGR) for the current
 	 * formatting flags, according to the standard specified in the IOFormat
-	 * object.
+	 * object. The string is only regenerated when the attributes change.
 	 * \return the terminal format string.
 	 */
-	const std::string format_string() const
+	const std::string& format_string() const
+	{
+		if (fmt_format_dirty) {
+			fmt_format_string = format_string(this->fmt_standard);
+			fmt_format_dirty = false;
+		}
+		return fmt_format_string;
+	}
+
+	/** Generate the shortest terminal format string which changes the
+	 * given (previously applied) attributes to the current ones, according
+	 * to the standard specified in the IOFormat object.
+	 * \param attr: the text attributes previously applied
+	 * \param bg: the background color previously applied
+	 * \param fg: the foreground color previously applied
+	 * \return the terminal format string, or an empty string if the
+	 * attributes are the same.
+	 */
+	const std::string format_string_from(const IOFormatTextAttr& attr,
+										 const IOFormatTextBG& bg,
+										 const IOFormatTextFG& fg) const;
+
+	/// \return true if any text attributes or colors are set
+	bool has_attributes() const
 	{
-		return format_string(this->fmt_standard);
+		return fmt_text_attr != IOFormatTextAttr::none ||
+			   fmt_text_bg != IOFormatTextBG::none ||
+			   fmt_text_fg != IOFormatTextFG::none;
 	}
 
 	/// Reset the text attributes and colors, but nothing else.
@@ -440,21 +477,25 @@ public:
 	}
 	IOFormat& operator<<(const IOFormatStandard& rhs)
 	{
+		fmt_format_dirty |= (fmt_standard != rhs);
 		fmt_standard = rhs;
 		return *this;
 	}
 	IOFormat& operator<<(const IOFormatTextAttr& rhs)
 	{
+		fmt_format_dirty |= (fmt_text_attr != rhs);
 		fmt_text_attr = rhs;
 		return *this;
 	}
 	IOFormat& operator<<(const IOFormatTextBG& rhs)
 	{
+		fmt_format_dirty |= (fmt_text_bg != rhs);
 		fmt_text_bg = rhs;
 		return *this;
 	}
 	IOFormat& operator<<(const IOFormatTextFG& rhs)
 	{
+		fmt_format_dirty |= (fmt_text_fg != rhs);
 		fmt_text_fg = rhs;
 		return *this;
 	}
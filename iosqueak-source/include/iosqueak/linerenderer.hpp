@@ -0,0 +1,82 @@
+#ifndef LINERENDERER_HPP
+#define LINERENDERER_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+#include "iosqueak/channel.hpp"
+
+/* Draws the line being edited, remembering what is already on screen so
+ * that each update only sends what changed: cursor moves, the changed
+ * characters, and insert/delete character sequences for the rest of the
+ * line. Updates are queued and written with a single write() on flush(),
+ * which the shell does once it has handled all of the waiting input.
+ * Other threads can print above the line with print_above(). */
+class LineRenderer
+{
+private:
+	// Where to write to.
+	int fd;
+
+	/* The channel whose output shares the terminal. Its messages are
+	 * dispatched before ours are written. */
+	Channel& chan;
+
+	// The prompt printed before the line.
+	std::string prompt;
+
+	// The text currently on screen after the prompt.
+	std::string shown;
+	// The cursor's position within 'shown'.
+	size_t cursor{0};
+	// Whether 'shown' and 'cursor' match the screen.
+	bool valid{false};
+
+	// Terminal output not yet written.
+	std::string pending;
+
+	// Held while using any of the above.
+	std::mutex lock;
+
+	// Queue the sequence to move the cursor from one column to another.
+	void move_cursor(size_t from, size_t to);
+
+	// Write out all queued updates, with the lock held.
+	void write_pending();
+
+public:
+	explicit LineRenderer(std::string_view prompt_text = ">>> ",
+						  int file = STDOUT_FILENO,
+						  Channel& output = ::channel)
+	: fd(file), chan(output), prompt(prompt_text)
+	{
+	}
+
+	/* Queue the updates needed to show the text, with the cursor at
+	 * the given position in it. */
+	void render(std::string_view text, size_t position);
+
+	/* Forget what is on screen, e.g. after something else was printed.
+	 * The next render() redraws the whole line. */
+	void invalidate()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		valid = false;
+	}
+
+	/* Write out all queued updates, after anything the channel was
+	 * still dispatching (e.g. on its writer thread). */
+	void flush();
+
+	/* Print text on its own, then redraw the line below it, if the line
+	 * is on screen. Otherwise, just print the text. */
+	void print_above(std::string_view text);
+
+	// Returns the updates not yet written.
+	const std::string& queued() const { return pending; }
+};
+
+#endif  // LINERENDERER_HPP
@@ -0,0 +1,89 @@
+#ifndef RAWTERMINAL_HPP
+#define RAWTERMINAL_HPP
+
+#include <cstddef>
+#include <termios.h>
+#include <unistd.h>
+
+/* Reads keypresses from a terminal in non-canonical (raw) mode. Input is
+ * read in bulk into a buffer, so a pasted command costs one read() instead
+ * of several system calls per byte. Raw mode is entered once for the
+ * lifetime of a session, rather than around every keypress. */
+class RawTerminal
+{
+private:
+	// The file descriptor to read from.
+	int fd;
+
+	// The terminal settings to restore, and whether they were saved.
+	struct termios saved;
+	bool raw{false};
+
+	// Bytes read, but not yet consumed.
+	char buffer[4096];
+	size_t pos{0};
+	size_t len{0};
+
+	// Read more input into the (empty) buffer. Returns false on EOF/error.
+	bool fill();
+
+public:
+	/* Enters raw mode on construction, and restores the terminal on
+	 * destruction, even if leaving by exception. */
+	class session
+	{
+	private:
+		RawTerminal& terminal;
+		bool entered;
+
+	public:
+		explicit session(RawTerminal& term)
+		: terminal(term), entered(term.enter())
+		{
+		}
+		session(const session&) = delete;
+		session& operator=(const session&) = delete;
+		~session()
+		{
+			if (entered) {
+				terminal.leave();
+			}
+		}
+	};
+
+	explicit RawTerminal(int file = STDIN_FILENO) : fd(file), saved() {}
+	RawTerminal(const RawTerminal&) = delete;
+	RawTerminal& operator=(const RawTerminal&) = delete;
+
+	/* Switch the terminal to raw mode. Returns false if it was already
+	 * raw, or isn't a terminal. */
+	bool enter();
+
+	// Restore the terminal's original settings.
+	void leave();
+
+	// Check if the terminal is in raw mode.
+	bool is_raw() const { return raw; }
+
+	/* Returns the next byte of input, waiting for it if needed, or -1
+	 * on end of input. Outside of a session, raw mode is entered just
+	 * for the read. */
+	int get();
+
+	// Returns the next byte of input without consuming it, or -1.
+	int peek();
+
+	// Returns the number of bytes already read and waiting.
+	size_t available() const { return len - pos; }
+
+	/* Parse the rest of an escape sequence, after the escape character
+	 * has been read. Returns the final character of a CSI ("\x1b[") or
+	 * SS3 ("\x1bO") sequence, storing its numeric parameter (or 0) in
+	 * 'param'. Returns -1, consuming nothing, if the escape character
+	 * isn't followed by either. */
+	int read_escape(int& param);
+
+	~RawTerminal() { leave(); }
+};
+
+#endif  // RAWTERMINAL_HPP
@@ -85,7 +85,7 @@ size_t lengthify(
 }
 
 template<typename T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
-size_t lengthify(
+constexpr size_t lengthify(
 	const T& val,
 	const IOFormatBase& base = IOFormatBase::dec,
 	const IOFormatSign& sign = IOFormatSign::automatic,
@@ -119,6 +119,24 @@ std::string stringify(const T& val, const IOFormat& fmt)
 	return _StringifyImpl<T>::stringify(val, fmt);
 }
 
+/** Convert anything to a string, appending it to an existing buffer
+ * instead of creating a new string.
+ * \param buf: the buffer to append to
+ * \param val: the value to convert
+ * \param fmt: the formatting to use
+ */
+template<typename T>
+void stringify_to(std::string& buf, const T& val, const IOFormat& fmt)
+{
+	_StringifyImpl<T>::stringify_to(buf, val, fmt);
+}
+
+template<typename T>
+void stringify_to(std::string& buf, const T& val)
+{
+	_StringifyImpl<T>::stringify_to(buf, val, IOFormat());
+}
+
 /** Fallback **/
 
 template<typename T, typename Enable /*=void*/>
@@ -133,6 +151,11 @@ struct _StringifyImpl {
 	{
 		return ::stringify_anything(val);
 	}
+
+	static void stringify_to(std::string& buf, const T& val, const IOFormat&)
+	{
+		buf += ::stringify_anything(val);
+	}
 };
 
 /* Stringify integers */
@@ -165,6 +188,18 @@ struct _StringifyImpl<
 						   fmt.numeral_case(),
 						   fmt.base_notation());
 	}
+
+	static void stringify_to(std::string& buf,
+							 const T& val,
+							 const IOFormat& fmt)
+	{
+		::stringify_integral_to(buf,
+								val,
+								fmt.base(),
+								fmt.sign(),
+								fmt.numeral_case(),
+								fmt.base_notation());
+	}
 };
 
 /* Stringify floating-point numbers. */
@@ -195,6 +230,17 @@ struct _StringifyImpl<
 						   fmt.sci_notation(),
 						   fmt.sign());
 	}
+
+	static void stringify_to(std::string& buf,
+							 const T& val,
+							 const IOFormat& fmt)
+	{
+		::stringify_floating_point_to(buf,
+									  val,
+									  fmt.decimal_places(),
+									  fmt.sci_notation(),
+									  fmt.sign());
+	}
 };
 
 /* Stringify char */
@@ -217,6 +263,13 @@ struct _StringifyImpl<char> {
 	{
 		return ::stringify(val, fmt.char_value());
 	}
+
+	static void stringify_to(std::string& buf,
+							 const char& val,
+							 const IOFormat& fmt)
+	{
+		::stringify_char_to(buf, val, fmt.char_value());
+	}
 };
 
 /* Stringify bool */
@@ -239,6 +292,13 @@ struct _StringifyImpl<bool> {
 	{
 		return ::stringify(val, fmt.bool_style());
 	}
+
+	static void stringify_to(std::string& buf,
+							 const bool& val,
+							 const IOFormat& fmt)
+	{
+		::stringify_boolean_to(buf, val, fmt.bool_style());
+	}
 };
 
 /* Stringify exceptions */
@@ -256,6 +316,13 @@ struct _StringifyImpl<
 	{
 		return ::stringify_exception(except);
 	}
+
+	static void stringify_to(std::string& buf,
+							 const T& except,
+							 const IOFormat&)
+	{
+		::stringify_exception_to(buf, except);
+	}
 };
 
 /* Stringify functions */
@@ -286,6 +353,13 @@ struct _StringifyImpl<std::bitset<N>> {
 	{
 		return ::stringify(bits, fmt.mem_sep());
 	}
+
+	static void stringify_to(std::string& buf,
+							 const std::bitset<N>& bits,
+							 const IOFormat& fmt)
+	{
+		::stringify_bitset_to(buf, bits, fmt.mem_sep());
+	}
 };
 
 /* Stringify MemLens */
@@ -341,6 +415,44 @@ inline std::string stringify(
 	return "";
 }
 
+/** Convert a MemLens to a string, appending it to a buffer.
+ * \param buf: the buffer to append to
+ * \param lens: the MemLens to convert
+ * \param fmt: the formatting to use
+ */
+inline void stringify_to(std::string& buf,
+						 const MemLens& lens,
+						 const IOFormat& fmt)
+{
+	// Memory dumps only support these bases.
+	auto base = fmt.base();
+	switch (base) {
+		case IOFormatBase::bin:
+			[[fallthrough]];
+		case IOFormatBase::oct:
+			[[fallthrough]];
+		case IOFormatBase::hex:
+			break;
+		default:
+			base = IOFormatBase::hex;
+	}
+
+	switch (fmt.ptr()) {
+		case IOFormatPtr::value:
+			throw std::invalid_argument("stringify() cannot retrieve the value "
+										"from a MemLens-captured pointer");
+		case IOFormatPtr::address:
+			stringify_address_to(buf, lens, fmt.numeral_case());
+			break;
+		case IOFormatPtr::pointer:
+			stringify_pointer_data_to(buf, lens);
+			break;
+		case IOFormatPtr::memory:
+			stringify_bytes_to(buf, lens, fmt.mem_sep(), base, fmt.numeral_case());
+			break;
+	}
+}
+
 template<>
 struct _StringifyImpl<MemLens> {
 	static std::string stringify(const MemLens& lens)
@@ -372,6 +484,13 @@ struct _StringifyImpl<MemLens> {
 						   base,
 						   fmt.numeral_case());
 	}
+
+	static void stringify_to(std::string& buf,
+							 const MemLens& lens,
+							 const IOFormat& fmt)
+	{
+		::stringify_to(buf, lens, fmt);
+	}
 };
 
 /* Stringify raw pointers */
@@ -431,6 +550,17 @@ struct _StringifyImpl<T*> {
 						   base,
 						   fmt.numeral_case());
 	}
+
+	static void stringify_to(std::string& buf,
+							 const T* ptr,
+							 const IOFormat& fmt)
+	{
+		if (fmt.ptr() == IOFormatPtr::value) {
+			buf += ::stringify_from_pointer(ptr);
+			return;
+		}
+		::stringify_to(buf, MemLens(ptr), fmt);
+	}
 };
 
 /* Stringify shared pointers */
@@ -491,6 +621,17 @@ struct _StringifyImpl<std::shared_ptr<T>> {
 						   base,
 						   fmt.numeral_case());
 	}
+
+	static void stringify_to(std::string& buf,
+							 const std::shared_ptr<T>& ptr,
+							 const IOFormat& fmt)
+	{
+		if (fmt.ptr() == IOFormatPtr::value) {
+			buf += ::stringify_from_pointer(ptr);
+			return;
+		}
+		::stringify_to(buf, MemLens(ptr), fmt);
+	}
 };
 
 /* Stringify weak pointers */
@@ -551,6 +692,17 @@ struct _StringifyImpl<std::weak_ptr<T>> {
 						   base,
 						   fmt.numeral_case());
 	}
+
+	static void stringify_to(std::string& buf,
+							 const std::weak_ptr<T>& ptr,
+							 const IOFormat& fmt)
+	{
+		if (fmt.ptr() == IOFormatPtr::value) {
+			buf += ::stringify_from_pointer(ptr);
+			return;
+		}
+		::stringify_to(buf, MemLens(ptr), fmt);
+	}
 };
 
 /* Stringify types */
@@ -566,6 +718,13 @@ struct _StringifyImpl<std::type_info> {
 	{
 		return ::stringify_type(type);
 	}
+
+	static void stringify_to(std::string& buf,
+							 const std::type_info& type,
+							 const IOFormat&)
+	{
+		buf += ::stringify_type(type);
+	}
 };
 
 template<>
@@ -579,6 +738,13 @@ struct _StringifyImpl<std::type_index> {
 	{
 		return ::stringify_type(type);
 	}
+
+	static void stringify_to(std::string& buf,
+							 const std::type_index& type,
+							 const IOFormat&)
+	{
+		buf += ::stringify_type(type);
+	}
 };
 
 /* Stringify strings. */
@@ -590,6 +756,13 @@ struct _StringifyImpl<const char*> {
 	{
 		return str;
 	}
+
+	static void stringify_to(std::string& buf,
+							 const char* str,
+							 const IOFormat&)
+	{
+		buf += str;
+	}
 };
 
 template<>
@@ -600,6 +773,13 @@ struct _StringifyImpl<std::string> {
 	{
 		return str;
 	}
+
+	static void stringify_to(std::string& buf,
+							 const std::string& str,
+							 const IOFormat&)
+	{
+		buf += str;
+	}
 };
 
 /* Stringify from a variadic list of arguments. */
@@ -646,22 +826,44 @@ std::string stringify_from_pointer(const std::weak_ptr<T>& ptr)
 	return stringify_from_pointer(shared.get());
 }
 
+/* Stringify tuples. */
+
+template<typename... Args>
+struct _StringifyImpl<std::tuple<Args...>> {
+	static std::string stringify(const std::tuple<Args...>& args)
+	{
+		return stringify(args, IOFormat());
+	}
+
+	static std::string stringify(const std::tuple<Args...>& args,
+								 const IOFormat& fmt)
+	{
+		std::string str = std::string();
+		stringify_to(str, args, fmt);
+		return str;
+	}
+
+	static void stringify_to(std::string& buf,
+							 const std::tuple<Args...>& args,
+							 const IOFormat& fmt)
+	{
+		// Stringify each element in turn, separated by commas.
+		std::apply(
+			[&buf, &fmt](auto const&... arg) {
+				size_t i = 0;
+				((::stringify_to(buf, arg, fmt),
+				  (++i == sizeof...(Args) ? void() : void(buf += ','))),
+				 ...);
+			},
+			args);
+	}
+};
+
 // Stringifies tuples.
-template <typename... Args>
+template<typename... Args>
 std::string stringify(std::tuple<Args...> args, const IOFormat iof = IOFormat())
 {
-	// Uses lambda in order to iterate and assign the strigigied args to the variable.
-    std::string stringified_tuples = std::apply([iof](auto const&... arg) {
-            std::string stringified_args;
-            size_t i = 0;
-
-			// Iterates through the args to stringify it and append it.
-            ((stringified_args += stringify(arg, iof) + (++i == sizeof...(Args) ? "" : ",")), ...);
-            
-            return stringified_args;
-        }, args);
-
-	return stringified_tuples;
+	return _StringifyImpl<std::tuple<Args...>>::stringify(args, iof);
 }
 
 #endif
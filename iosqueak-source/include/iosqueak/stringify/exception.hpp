@@ -52,147 +52,209 @@
 #include <stdexcept>
 #include <string>
 #include <system_error>
+#include <type_traits>
 #include <typeinfo>
 
 #include "iosqueak/stringify/numbers.hpp"
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::exception& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::exception& except)
 {
-	return std::string("[EXCEPTION: ") + except.what() + "]";
+	buf += "[EXCEPTION: ";
+	buf += except.what();
+	buf += ']';
 }
 
 // "BAD" ERRORS
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::bad_alloc& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::bad_alloc& except)
 {
-	return std::string("[BAD ALLOC: ") + except.what() + "]";
+	buf += "[BAD ALLOC: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::bad_array_new_length& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::bad_array_new_length& except)
 {
-	return std::string("[BAD ARRAY NEW LENGTH: ") + except.what() + "]";
+	buf += "[BAD ARRAY NEW LENGTH: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::bad_cast& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::bad_cast& except)
 {
-	return std::string("[BAD CAST: ") + except.what() + "]";
+	buf += "[BAD CAST: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::bad_exception& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::bad_exception& except)
 {
-	return std::string("[BAD EXCEPTION: ") + except.what() + "]";
+	buf += "[BAD EXCEPTION: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::bad_function_call& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::bad_function_call& except)
 {
-	return std::string("[BAD FUNCTION CALL: ") + except.what() + "]";
+	buf += "[BAD FUNCTION CALL: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::bad_typeid& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::bad_typeid& except)
 {
-	return std::string("[BAD TYPEID: ") + except.what() + "]";
+	buf += "[BAD TYPEID: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::bad_weak_ptr& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::bad_weak_ptr& except)
 {
-	return std::string("[BAD WEAK_PTR: ") + except.what() + "]";
+	buf += "[BAD WEAK_PTR: ";
+	buf += except.what();
+	buf += ']';
 }
 
 // LOGIC ERRORS
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::logic_error& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::logic_error& except)
 {
-	return std::string("[LOGIC ERROR: ") + except.what() + "]";
+	buf += "[LOGIC ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::domain_error& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::domain_error& except)
 {
-	return std::string("[DOMAIN ERROR: ") + except.what() + "]";
+	buf += "[DOMAIN ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::future_error& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::future_error& except)
 {
-	return std::string("[FUTURE ERROR: ") + except.what() + "]";
+	buf += "[FUTURE ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::invalid_argument& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::invalid_argument& except)
 {
-	return std::string("[INVALID ARGUMENT ERROR: ") + except.what() + "]";
+	buf += "[INVALID ARGUMENT ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::length_error& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::length_error& except)
 {
-	return std::string("[LENGTH ERROR: ") + except.what() + "]";
+	buf += "[LENGTH ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::out_of_range& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::out_of_range& except)
 {
-	return std::string("[OUT OF RANGE ERROR: ") + except.what() + "]";
+	buf += "[OUT OF RANGE ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
 // RUNTIME ERRORS
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::runtime_error& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::runtime_error& except)
 {
-	return std::string("[RUNTIME ERROR: ") + except.what() + "]";
+	buf += "[RUNTIME ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::overflow_error& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::overflow_error& except)
 {
-	return std::string("[OVERFLOW ERROR: ") + except.what() + "]";
+	buf += "[OVERFLOW ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::range_error& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::range_error& except)
 {
-	return std::string("[RANGE ERROR: ") + except.what() + "]";
+	buf += "[RANGE ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::underflow_error& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::underflow_error& except)
 {
-	return std::string("[UNDERFLOW ERROR: ") + except.what() + "]";
+	buf += "[UNDERFLOW ERROR: ";
+	buf += except.what();
+	buf += ']';
 }
 
 // SYSTEM ERROR
 
-static std::string stringify_error_code(const std::error_code& code)
+[[maybe_unused]] static void stringify_error_code_to(
+	std::string& buf, const std::error_code& code)
+{
+	stringify_integral_to(buf, code.value());
+}
+
+[[maybe_unused]] static std::string stringify_error_code(
+	const std::error_code& code)
 {
 	return stringify_integral(code.value());
 }
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::system_error& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::system_error& except)
 {
-	return std::string("[SYSTEM ERROR: (" +
-					   stringify_error_code(except.code()) + ") " +
-					   except.what() + "]");
+	buf += "[SYSTEM ERROR: (";
+	stringify_error_code_to(buf, except.code());
+	buf += ") ";
+	buf += except.what();
+	buf += ']';
 }
 
 // IOS ERROR
 
-[[maybe_unused]] static std::string stringify_exception(
-	const std::ios_base::failure& except)
+[[maybe_unused]] static void stringify_exception_to(
+	std::string& buf, const std::ios_base::failure& except)
+{
+	buf += "[IOS_BASE FAILURE: (";
+	stringify_error_code_to(buf, except.code());
+	buf += ") ";
+	buf += except.what();
+	buf += ']';
+}
+
+/** Convert an exception to a string.
+ * The most specific stringify_exception_to() overload is used.
+ * \param except: the exception to convert
+ * \return the string representation of the exception
+ */
+template<typename T,
+		 std::enable_if_t<std::is_base_of<std::exception, T>::value, int> = 0>
+std::string stringify_exception(const T& except)
 {
-	return std::string("[IOS_BASE FAILURE: (" +
-					   stringify_error_code(except.code()) + ") " +
-					   except.what() + "]");
+	std::string str = std::string();
+	stringify_exception_to(str, except);
+	return str;
 }
 
 #endif
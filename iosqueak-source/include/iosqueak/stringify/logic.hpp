@@ -75,24 +75,44 @@ inline size_t lengthify_boolean(
 	return 0;
 }
 
-inline std::string stringify_boolean(
-	const bool& val, const IOFormatBoolStyle& fmt = IOFormatBoolStyle::lower)
+/** Convert a boolean to a string, appending it to a buffer.
+ * \param buf: the buffer to append to
+ * \param val: the boolean to convert
+ * \param fmt: the format to represent the boolean in
+ */
+inline void stringify_boolean_to(
+	std::string& buf,
+	const bool& val,
+	const IOFormatBoolStyle& fmt = IOFormatBoolStyle::lower)
 {
 	switch (fmt) {
 		case IOFormatBoolStyle::lower:
-			return val ? "true" : "false";
+			buf += val ? "true" : "false";
+			break;
 		case IOFormatBoolStyle::upper:
-			return val ? "True" : "False";
+			buf += val ? "True" : "False";
+			break;
 		case IOFormatBoolStyle::caps:
-			return val ? "TRUE" : "FALSE";
+			buf += val ? "TRUE" : "FALSE";
+			break;
 		case IOFormatBoolStyle::numeral:
-			return val ? "1" : "0";
+			buf += val ? '1' : '0';
+			break;
 		case IOFormatBoolStyle::test:
-			return val ? "PASS" : "FAIL";
+			buf += val ? "PASS" : "FAIL";
+			break;
 		case IOFormatBoolStyle::scott:
-			return val ? "yea" : "nay";
+			buf += val ? "yea" : "nay";
+			break;
 	}
-	return "";
+}
+
+inline std::string stringify_boolean(
+	const bool& val, const IOFormatBoolStyle& fmt = IOFormatBoolStyle::lower)
+{
+	std::string str = std::string();
+	stringify_boolean_to(str, val, fmt);
+	return str;
 }
 
 #endif
@@ -44,7 +44,9 @@
 #ifndef IOSQUEAK_STRINGIFY_MEMORY_HPP
 #define IOSQUEAK_STRINGIFY_MEMORY_HPP
 
-#include <math.h>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -56,62 +58,185 @@
 #include "iosqueak/tools/memlens.hpp"
 #include "iosqueak/utilities/bitfield.hpp"
 
-/** Convert bitset to string.
+/** Calculate the exact length of a memory dump.
+ * \param len: the number of bytes dumped
+ * \param sep: which separators to use in the string representation
+ * \param base: the base to use (must be hex/bin/oct)
+ * \return the number of characters in the dump
+ */
+constexpr size_t lengthify_memory(size_t len,
+								  IOFormatMemSep sep = IOFormatMemSep::none,
+								  IOFormatBase base = IOFormatBase::hex)
+{
+	size_t digits = 0;
+	switch (base) {
+		case IOFormatBase::bin:
+			digits = 8;
+			break;
+		case IOFormatBase::oct:
+			digits = 4;
+			break;
+		case IOFormatBase::hex:
+			digits = 2;
+			break;
+		default:
+			throw std::invalid_argument(
+				"stringify_byte() only supports bases bin, oct, and hex");
+	}
+
+	const bool byte_sep = flags_check(sep, IOFormatMemSep::byte);
+	size_t length = len * digits;
+	if (byte_sep) {
+		length += len;
+	}
+	// A word is 8 bytes.
+	if (flags_check(sep, IOFormatMemSep::word)) {
+		length += (len / 8) * (byte_sep ? 2 : 1);
+	}
+	return length;
+}
+
+/** Dump raw memory to a string, appending it to a buffer, from the last
+ * byte to the first. The output is sized exactly up front, and the digits
+ * are generated with SSE2 or AVX2 where the processor supports them.
+ * Used by stringify_byte_to() and stringify_bytes_to().
+ * \param buf: the buffer to append to
+ * \param data: the first byte of memory
+ * \param len: the number of bytes
+ * \param sep: which separators to use in the string representation
+ * \param base: the base to use (must be hex/bin/oct)
+ * \param num_case: the case to use for digits > 9
+ */
+void _stringify_memory_to(std::string& buf,
+						  const uint8_t* data,
+						  size_t len,
+						  IOFormatMemSep sep,
+						  IOFormatBase base,
+						  IOFormatNumCase num_case);
+
+/** Write the bits of a bitset as binary digits, from the lowest bit to
+ * the highest, eight bits at a time from a lookup table. Separators follow
+ * every full byte and every full 64-bit word, as requested.
+ * Used by stringify_bitset_to().
+ * \param out: where to write the digits, with room for all of them
+ * \param bytes: the bits, eight to a byte, with the first bit in the
+ * lowest position of the first byte
+ * \param count: the number of bits to write
+ * \param sep: which separators to use in the string representation
+ * \return the position just past the last character written
+ */
+char* _stringify_bits(char* out,
+					  const uint8_t* bytes,
+					  size_t count,
+					  IOFormatMemSep sep);
+
+/** Check whether a bitset type stores its bits eight to a byte, in order,
+ * starting at the first byte of the object. Every mainstream standard
+ * library does so on little-endian machines.
+ * \return true if the bits can be read straight from the object
+ */
+template<size_t LONGNESS>
+bool _bitset_is_packed()
+{
+	if (sizeof(std::bitset<LONGNESS>) * 8 < LONGNESS) {
+		return false;
+	}
+
+	// Set a scattering of bits, and make sure only those bits show up.
+	const size_t probes[] = {0, 9, LONGNESS / 2 + 3, LONGNESS - 1};
+	std::bitset<LONGNESS> probe;
+	for (size_t bit : probes) {
+		if (bit < LONGNESS) {
+			probe.set(bit);
+		}
+	}
+
+	const uint8_t* raw = reinterpret_cast<const uint8_t*>(&probe);
+	for (size_t bit = 0; bit < LONGNESS; ++bit) {
+		if (((raw[bit / 8] >> (bit % 8)) & 1) != probe.test(bit)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Convert bitset to string, appending it to a buffer.
  * Only supports printing to binary.
+ * \param buf: the buffer to append to
  * \param bits: the bitset to stringify
  * \param sep: the memory separation formatting flag
- * \return string equivalent of bitset
  */
 template<size_t LONGNESS>
-std::string stringify_bitset(const std::bitset<LONGNESS>& bits,
-							 IOFormatMemSep sep = IOFormatMemSep::all)
+void stringify_bitset_to(std::string& buf,
+						 const std::bitset<LONGNESS>& bits,
+						 IOFormatMemSep sep = IOFormatMemSep::all)
 {
 	// Avoiding magic numbers.
 	const size_t BYTE_SIZE = 8;
 	const size_t WORD_SIZE = 64;
 
-	// Without memory separation formatting, string length is bitset length.
-	size_t len = LONGNESS;
-
-	// Add reserved space in string for byte/word separation, as requested.
-	switch (sep) {
-		case IOFormatMemSep::all:
-			len += floor(LONGNESS / WORD_SIZE) * 2;
-			[[fallthrough]];
-		case IOFormatMemSep::byte:
-			len += floor(LONGNESS / BYTE_SIZE);
-			break;
-		case IOFormatMemSep::word:
-			len += floor(LONGNESS / WORD_SIZE);
-			break;
-		case IOFormatMemSep::none:
-			break;
+	// Full bytes are laid out like a memory dump; leftover bits follow.
+	size_t start = buf.length();
+	buf.resize(start +
+			   lengthify_memory(LONGNESS / BYTE_SIZE, sep, IOFormatBase::bin) +
+			   LONGNESS % BYTE_SIZE);
+	char* out = &buf[start];
+
+	// Where we can, read the bits straight out of the bitset.
+	static const bool packed = _bitset_is_packed<LONGNESS>();
+	if (packed) {
+		_stringify_bits(out, reinterpret_cast<const uint8_t*>(&bits), LONGNESS,
+						sep);
+		return;
 	}
 
-	// Create a string with the necessary space reserved.
-	std::string str = std::string();
-	str.reserve(len);
-
-	// Convert each bit to its binary string representation.
-	for (size_t i = 0; i < LONGNESS; ++i) {
-		str += (bits.test(i) ? "1" : "0");
-
-		// Insert byte separation if desired.
-		if (flags_check(sep, IOFormatMemSep::byte) &&
-			(i + 1) % BYTE_SIZE == 0) {
-			str += ' ';
-		}
-
-		// Insert word separation if desired.
-		if (flags_check(sep, IOFormatMemSep::word) &&
-			(i + 1) % WORD_SIZE == 0) {
-			str += (flags_check(sep, IOFormatMemSep::byte)) ? "| " : "|";
+	// Otherwise, peel off the lowest word at a time.
+	const std::bitset<LONGNESS> low_word(~0ULL);
+	std::bitset<LONGNESS> rest(bits);
+	for (size_t done = 0; done < LONGNESS; done += WORD_SIZE) {
+		uint64_t word = (rest & low_word).to_ullong();
+		uint8_t bytes[WORD_SIZE / BYTE_SIZE];
+		for (uint8_t& byte : bytes) {
+			byte = static_cast<uint8_t>(word);
+			word >>= BYTE_SIZE;
 		}
+		out = _stringify_bits(out, bytes, std::min(WORD_SIZE, LONGNESS - done),
+							  sep);
+		rest >>= WORD_SIZE;
 	}
+}
 
+/** Convert bitset to string.
+ * Only supports printing to binary.
+ * \param bits: the bitset to stringify
+ * \param sep: the memory separation formatting flag
+ * \return string equivalent of bitset
+ */
+template<size_t LONGNESS>
+std::string stringify_bitset(const std::bitset<LONGNESS>& bits,
+							 IOFormatMemSep sep = IOFormatMemSep::all)
+{
+	std::string str = std::string();
+	stringify_bitset_to(str, bits, sep);
 	return str;
 }
 
+/** Convert integer representations of a single byte to a string,
+ * appending it to a buffer.
+ * Note: This uses separate (optimized) logic from stringify_integral!
+ * \param buf: the buffer to append to
+ * \param byte: the byte to convert as an unsigned integer (uint8_t)
+ * \param base: the base to use for the conversion (should be hex/bin/oct)
+ * \param num_case: the case to use for digits > 9
+ */
+inline void stringify_byte_to(std::string& buf,
+							  const uint8_t byte,
+							  IOFormatBase base = IOFormatBase::hex,
+							  IOFormatNumCase num_case = IOFormatNumCase::upper)
+{
+	_stringify_memory_to(buf, &byte, 1, IOFormatMemSep::none, base, num_case);
+}
+
 /** Convert integer representations of a single byte to a string.
  * Note: This uses separate (optimized) logic from stringify_integral!
  * \param byte: the byte to convert as an unsigned integer (uint8_t)
@@ -123,56 +248,37 @@ inline std::string stringify_byte(const uint8_t byte,
 						   IOFormatBase base = IOFormatBase::hex,
 						   IOFormatNumCase num_case = IOFormatNumCase::upper)
 {
-	// Calculate the length of the string based on the desired base.
-	size_t length = 0;
-
-	switch (base) {
-		case IOFormatBase::bin:
-			length = 8;
-			break;
-
-		case IOFormatBase::oct:
-			length = 4;
-			break;
-
-		case IOFormatBase::hex:
-			length = 2;
-			break;
-
-		default:
-			throw std::invalid_argument(
-				"stringify_byte() only supports bases bin, oct, and hex");
-	}
-
-	// Reserve space in the string.
 	std::string str = std::string();
-	str.reserve(length);
-
-	// Get a mutable copy of the integer.
-	uint8_t val = byte;
-	// Conver the base to an integer for use in the algorithm.
-	unsigned int _base = static_cast<unsigned int>(base);
-
-	/* Get digits for all positions in the number, thereby zero-padding.
-	 * Store each digit directly in the appropriate position, so we don't
-	 * have to reverse. */
-	for (size_t i = 0; i < length; ++i) {
-		size_t digit = val % _base;
-
-		switch (num_case) {
-			case IOFormatNumCase::lower:
-				str += DIGIT_CHARS_LOWER[digit];
-				break;
-
-			case IOFormatNumCase::upper:
-				str += DIGIT_CHARS_UPPER[digit];
-				break;
-		}
+	stringify_byte_to(str, byte, base, num_case);
+	return str;
+}
 
-		val /= _base;
+/** Convert integer representations of binary data to a string,
+ * appending it to a buffer.
+ * Note: This uses separate (optimized) logic from stringify_integral!
+ * \param buf: the buffer to append to
+ * \param bytes: the integer representing the binary data
+ * \param sep: which separators to use in the string representation
+ * \param base: the base to use for the conversion (should probably be
+ * hex/bin/oct) \param num_case: the case to use for digits > 9
+ */
+template<typename T>
+void stringify_bytes_to(std::string& buf,
+						const T& bytes,
+						IOFormatMemSep sep = IOFormatMemSep::none,
+						IOFormatBase base = IOFormatBase::hex,
+						IOFormatNumCase num_case = IOFormatNumCase::upper)
+{
+	// Lay the bytes out from least to most significant...
+	uint8_t raw[sizeof(T)];
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		raw[i] = static_cast<uint8_t>(bytes >> (8 * i));
 	}
 
-	return str;
+	// ...so they're dumped from most to least significant.
+	_stringify_memory_to(buf, raw, sizeof(T), sep, base, num_case);
+
+	// We never use prefixes on memory dumps.
 }
 
 /** Convert integer representations of binary data to a string.
@@ -189,32 +295,64 @@ std::string stringify_bytes(const T& bytes,
 							IOFormatBase base = IOFormatBase::hex,
 							IOFormatNumCase num_case = IOFormatNumCase::upper)
 {
-	// Reserve is presently not practical on this string because of seperators.
 	std::string str = std::string();
+	stringify_bytes_to(str, bytes, sep, base, num_case);
+	return str;
+}
 
-	// Parse each byte in the number, from last to first.
-	for (int i = sizeof(T) - 1; i >= 0; --i) {
-		// Convert the byte to string.
-		str += stringify_byte(static_cast<uint8_t>(bytes >> (8 * i)),
-							  base,
-							  num_case);
-
-		// Insert byte separation if desired.
-		if (static_cast<bool>(sep & IOFormatMemSep::byte)) {
-			str += ' ';
-		}
-
-		// Insert word separation if desired.
-		if (static_cast<bool>(sep & IOFormatMemSep::word) && i + 1 % 8 == 0) {
-			str += (static_cast<bool>(sep & IOFormatMemSep::byte)) ? "| " : "|";
-		}
-	}
+/** Convert a span of binary data to a string, appending it to a buffer.
+ * \param buf: the buffer to append to
+ * \param bytes: the span of binary data
+ * \param sep: which separators to use in the string representation
+ * \param base: the base to use for the conversion (should probably be
+ * hex/bin/oct) \param num_case: the case to use for digits > 9
+ */
+inline void stringify_bytes_to(std::string& buf,
+							   MemSpan bytes,
+							   IOFormatMemSep sep = IOFormatMemSep::none,
+							   IOFormatBase base = IOFormatBase::hex,
+							   IOFormatNumCase num_case = IOFormatNumCase::upper)
+{
+	// Parse each byte in the span, from last to first.
+	_stringify_memory_to(buf, bytes.data(), bytes.size(), sep, base, num_case);
 
 	// We never use prefixes on memory dumps.
+}
 
+/** Convert a span of binary data to a string.
+ * \param bytes: the span of binary data
+ * \param sep: which separators to use in the string representation
+ * \param base: the base to use for the conversion (should probably be
+ * hex/bin/oct) \param num_case: the case to use for digits > 9 \return the
+ * string representation of the data
+ */
+inline std::string stringify_bytes(MemSpan bytes,
+							IOFormatMemSep sep = IOFormatMemSep::none,
+							IOFormatBase base = IOFormatBase::hex,
+							IOFormatNumCase num_case = IOFormatNumCase::upper)
+{
+	std::string str = std::string();
+	stringify_bytes_to(str, bytes, sep, base, num_case);
 	return str;
 }
 
+/** Convert vector representation of binary data to a string,
+ * appending it to a buffer.
+ * \param buf: the buffer to append to
+ * \param bytes: the vector representing the binary data
+ * \param sep: which separators to use in the string representation
+ * \param base: the base to use for the conversion (should probably be
+ * hex/bin/oct) \param num_case: the case to use for digits > 9
+ */
+inline void stringify_bytes_to(std::string& buf,
+							   const std::vector<uint8_t>& bytes,
+							   IOFormatMemSep sep = IOFormatMemSep::none,
+							   IOFormatBase base = IOFormatBase::hex,
+							   IOFormatNumCase num_case = IOFormatNumCase::upper)
+{
+	stringify_bytes_to(buf, MemSpan(bytes), sep, base, num_case);
+}
+
 /** Convert vector representation of binary data to a string.
  * \param bytes: the vector representing the binary data
  * \param sep: which separators to use in the string representation
@@ -227,30 +365,28 @@ inline std::string stringify_bytes(const std::vector<uint8_t>& bytes,
 							IOFormatBase base = IOFormatBase::hex,
 							IOFormatNumCase num_case = IOFormatNumCase::upper)
 {
-	// Reserve is presently not practical on this string because of seperators.
 	std::string str = std::string();
-
-	// Parse each byte in the vector, from last to first.
-	for (size_t i = bytes.size(); i > 0; --i) {
-		// Convert the byte to string.
-		str += stringify_byte(bytes[i - 1], base, num_case);
-
-		// Insert byte separation if desired.
-		if (static_cast<bool>(sep & IOFormatMemSep::byte)) {
-			str += ' ';
-		}
-
-		// Insert word separation if desired.
-		if (static_cast<bool>(sep & IOFormatMemSep::word) && i + 1 % 8 == 0) {
-			str += (static_cast<bool>(sep & IOFormatMemSep::byte)) ? "| " : "|";
-		}
-	}
-
-	// We never use prefixes on memory dumps.
-
+	stringify_bytes_to(str, bytes, sep, base, num_case);
 	return str;
 }
 
+/** Convert binary data captured by MemLens to a string,
+ * appending it to a buffer.
+ * \param buf: the buffer to append to
+ * \param lens: the MemLens to acquire binary data from
+ * \param sep: which separators to use in the string representation
+ * \param base: the base to use for the conversion (should probably be
+ * hex/bin/oct) \param num_case: the case to use for digits > 9
+ */
+inline void stringify_bytes_to(std::string& buf,
+							   const MemLens& lens,
+							   IOFormatMemSep sep = IOFormatMemSep::none,
+							   IOFormatBase base = IOFormatBase::hex,
+							   IOFormatNumCase num_case = IOFormatNumCase::upper)
+{
+	stringify_bytes_to(buf, lens.view(), sep, base, num_case);
+}
+
 /** Convert binary data captured by MemLens to a string.
  * \param lens: the MemLens to acquire binary data from
  * \param sep: which separators to use in the string representation
@@ -263,7 +399,45 @@ inline std::string stringify_bytes(const MemLens& lens,
 							IOFormatBase base = IOFormatBase::hex,
 							IOFormatNumCase num_case = IOFormatNumCase::upper)
 {
-	return stringify_bytes(lens.memory(), sep, base, num_case);
+	return stringify_bytes(lens.view(), sep, base, num_case);
+}
+
+/**Convert a pointer (via MemLens) to a string representing the address,
+ * appending it to a buffer.
+ * Does not export the flag value, only the memory address.
+ * \param buf: the buffer to append to
+ * \param lens: the pointer (via MemLens) to convert
+ * \param num_case: letter case to use for digits greater than 9
+ */
+inline void stringify_address_to(
+	std::string& buf,
+	const MemLens& lens,
+	const IOFormatNumCase& num_case = IOFormatNumCase::upper)
+{
+	// Avoiding magic numbers: the width of a 64-bit address in hex.
+	const size_t ADDRESS_DIGITS = 16;
+
+	// Start with the 0x prefix, and remember where the digits begin.
+	buf += "0x";
+	size_t digits = buf.length();
+
+	/* Convert the address to a hexadecimal integer,
+	 * but leave off the prefix, as that's added in this function.
+	 * A null address is just zero padding. */
+	if (lens.address() != 0) {
+		stringify_integral_to(buf,
+							  lens.address(),
+							  IOFormatBase::hex,
+							  IOFormatSign::automatic,
+							  num_case,
+							  IOFormatBaseNotation::none);
+	}
+
+	// Zero-pad the address to the full width.
+	size_t written = buf.length() - digits;
+	if (written < ADDRESS_DIGITS) {
+		buf.insert(digits, ADDRESS_DIGITS - written, '0');
+	}
 }
 
 /**Convert a pointer (via MemLens) to a string representing the address.
@@ -275,49 +449,40 @@ inline std::string stringify_address(
 	const MemLens& lens,
 	const IOFormatNumCase& num_case = IOFormatNumCase::upper)
 {
-	/* Define the null address for a 64-bit system.
-	 * We'll partially overwrite with the address to achieve zero padding.
-	 * We add two extra zeroes to the front to facilitate the 0x prefix. */
-	std::string str = std::string(16 + 2, '0');
-	// Replace in the 'x' to create the 0x prefix.
-	str.replace(1, 1, "x");
-
-	// If the address is null, just return the null address string.
-	if (lens.address() == 0) {
-		return str;
-	}
-
-	/* Convert the address to a hexadecimal integer,
-	 * but leave off the prefix, as that'd added in this function. */
-	std::string addr = stringify_integral(lens.address(),
-										  IOFormatBase::hex,
-										  IOFormatSign::automatic,
-										  num_case,
-										  IOFormatBaseNotation::none);
-
-	// Replace the integer string we received into the address string.
-	str.replace(str.length() - addr.length(), addr.length(), addr);
-
+	std::string str = std::string();
+	stringify_address_to(str, lens, num_case);
 	return str;
 }
 
-inline std::string stringify_pointer_data(const MemLens& lens)
+/**Describe the pointer type (via MemLens), appending it to a buffer.
+ * \param buf: the buffer to append to
+ * \param lens: the pointer (via MemLens) to describe
+ */
+inline void stringify_pointer_data_to(std::string& buf, const MemLens& lens)
 {
-	std::string str = "";
-	std::string type = stringify_type(lens.data_type());
-
 	switch (lens.pointer_type()) {
 		case PtrType::raw:
-			str = "[" + type + "*]";
+			buf += '[';
+			buf += stringify_type(lens.data_type());
+			buf += "*]";
 			break;
 		case PtrType::shared:
-			str = "[shared_ptr<" + type + ">]";
+			buf += "[shared_ptr<";
+			buf += stringify_type(lens.data_type());
+			buf += ">]";
 			break;
 		case PtrType::weak:
-			str = "[weak_ptr<" + type + ">]";
+			buf += "[weak_ptr<";
+			buf += stringify_type(lens.data_type());
+			buf += ">]";
 			break;
 	}
+}
 
+inline std::string stringify_pointer_data(const MemLens& lens)
+{
+	std::string str = std::string();
+	stringify_pointer_data_to(str, lens);
 	return str;
 }
 
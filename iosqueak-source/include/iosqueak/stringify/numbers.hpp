@@ -44,7 +44,12 @@
 #ifndef IOSQUEAK_STRINGIFY_NUMBERS_HPP
 #define IOSQUEAK_STRINGIFY_NUMBERS_HPP
 
+#include <charconv>
 #include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
 #include <string>
 #include <type_traits>
 
@@ -55,26 +60,92 @@
 inline const char* DIGIT_CHARS_UPPER = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
 inline const char* DIGIT_CHARS_LOWER = "0123456789abcdefghijklmnopqrstuvwxyz";
 
+/// Every pair of decimal digits from "00" to "99", for writing two at a time.
+inline constexpr char DIGIT_PAIRS_DEC[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/// Lookup tables for counting the digits of an integer in constant time.
+struct _IntegralLengthTables {
+	/// The fewest digits of any number with a given bit width, by base.
+	uint8_t digits[37][65];
+	/** The smallest number with a given bit width which needs one more
+	 * digit than that, by base, or 0 if there is no such number. */
+	uint64_t threshold[37][65];
+};
+
+/** Generate the integer length tables for bases 2 through 36.
+ * \return the tables
+ */
+constexpr _IntegralLengthTables _make_integral_length_tables()
+{
+	_IntegralLengthTables tables{};
+
+	for (uint64_t base = 2; base <= 36; ++base) {
+		for (unsigned int width = 1; width <= 64; ++width) {
+			// The smallest and largest numbers with this bit width.
+			const uint64_t lowest = uint64_t(1) << (width - 1);
+			const uint64_t highest =
+				(width == 64) ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+
+			// Count the digits of the smallest number.
+			uint8_t digits = 0;
+			for (uint64_t number = lowest; number; number /= base) {
+				++digits;
+			}
+			tables.digits[base][width] = digits;
+
+			// The smallest number with one more digit is base^digits.
+			uint64_t power = 1;
+			bool overflow = false;
+			for (uint8_t i = 0; i < digits && !overflow; ++i) {
+				if (power > highest / base) {
+					overflow = true;
+				} else {
+					power *= base;
+				}
+			}
+			tables.threshold[base][width] =
+				(!overflow && power <= highest) ? power : 0;
+		}
+	}
+
+	return tables;
+}
+
+inline constexpr _IntegralLengthTables INTEGRAL_LENGTH_TABLES =
+	_make_integral_length_tables();
+
 /**Count the number of characters necessary to represent an integer
  * as a string. Does not count the null terminator.
- * Based on http://stackoverflow.com/a/1489873/472647
+ * Runs in constant time, using the bit width of the number to look up
+ * its digit count, and can be evaluated at compile time.
  * \param the number to convert to a string
  * \param the base, default decimal
  * \return the calculated string length */
 template<typename T>
-size_t lengthify_integral(
+constexpr size_t lengthify_integral(
 	const T& val,
 	const IOFormatBase& base = IOFormatBase::dec,
 	const IOFormatSign& sign = IOFormatSign::automatic,
 	const IOFormatBaseNotation notation = IOFormatBaseNotation::prefix)
 {
+	static_assert(sizeof(T) <= sizeof(uint64_t),
+				  "lengthify_integral() supports up to 64-bit integers.");
+
 	unsigned int _base = static_cast<unsigned int>(base);
 
+	// Zero is always written as a bare "0", without sign or notation.
+	if (val == 0) {
+		return 1;
+	}
+
 	/* Count the negative sign if the number is negative, or if signs should
-	 * always be included.
-	 * If the number is literally "0", the length is also 1.
-	 * For all positive numbers, start from 0. */
-	size_t length = (val <= 0 || sign == IOFormatSign::always) ? 1 : 0;
+	 * always be included. For all positive numbers, start from 0. */
+	size_t length = (val < 0 || sign == IOFormatSign::always) ? 1 : 0;
 
 	if (notation == IOFormatBaseNotation::prefix &&
 		(_base == 2 || _base == 3 || _base == 8 || _base == 12 ||
@@ -88,12 +159,25 @@ size_t lengthify_integral(
 		}
 	}
 
-	// Get the absolute value of the integer.
-	T number = (val >= 0) ? val : -val;
+	// Get the absolute value of the integer, safely for the most negative.
+	using U = std::make_unsigned_t<T>;
+	U number = static_cast<U>(val);
+	if constexpr (std::is_signed<T>::value) {
+		if (val < 0) {
+			number = static_cast<U>(U(0) - number);
+		}
+	}
 
-	// Count the number of digits in the absolute value of the integer.
-	while (number) {
-		number /= _base;
+	if (_base < 2 || _base > 36) {
+		return length;
+	}
+
+	// Count the digits in the absolute value of the integer.
+	const unsigned int width =
+		64 - __builtin_clzll(static_cast<unsigned long long int>(number));
+	const uint64_t threshold = INTEGRAL_LENGTH_TABLES.threshold[_base][width];
+	length += INTEGRAL_LENGTH_TABLES.digits[_base][width];
+	if (threshold != 0 && number >= threshold) {
 		++length;
 	}
 
@@ -118,18 +202,19 @@ size_t lengthify_floating_point(
 	const IOFormatSign& sign = IOFormatSign::automatic)
 {
 	// Get the absolute value of the number.
-	T number = (val >= 0) ? val : -val;
+	T number = std::fabs(val);
 
-	int magnitude = 0;
+	// The exponent of the leading digit, as stringify_floating_point() has it.
+	int magnitude = (number == 0 || !std::isfinite(number))
+						? 0
+						: static_cast<int>(floor(log10(number)));
 	bool useExp = false;
 
 	switch (sci) {
 		case IOFormatSciNotation::always:
-			magnitude = log10(val);
 			useExp = true;
 			break;
 		case IOFormatSciNotation::automatic:
-			magnitude = log10(val);
 			useExp = (magnitude > 12 || magnitude < -5);
 			break;
 		case IOFormatSciNotation::never:
@@ -140,36 +225,115 @@ size_t lengthify_floating_point(
 
 	/* If the number is positive, start with 1 for the decimal point.
 	 * If negative, also add 1 to the length for the negative sign. */
-	size_t len = (val < 0 || sign == IOFormatSign::always) ? 2 : 1;
+	size_t len = (std::signbit(val) || sign == IOFormatSign::always) ? 2 : 1;
+
+	// Not-a-number and infinity are short words.
+	if (!std::isfinite(number)) {
+		return len + 3;
+	}
+
+	if (places.places == IOFormatDecimalPlaces::shortest) {
+		// At most this many significant digits, plus a trailing zero.
+		len += std::numeric_limits<T>::max_digits10 + 1;
+		/* Add space for the exponent or, without it, for any zeros between
+		 * the digits and the decimal point. */
+		if (useExp) {
+			len += 6;
+		} else if (number >= 1) {
+			// The whole digits beyond the significant ones are zeros.
+			len += static_cast<size_t>(log10(number)) + 1;
+		} else if (number != 0) {
+			// The leading "0" and the zeros right after the decimal point.
+			len += static_cast<size_t>(std::ceil(-log10(number))) + 1;
+		}
+		return len;
+	}
+
+	// At least one decimal place is always shown, even if it is "0".
+	const size_t decimals =
+		(places.places > 0) ? static_cast<size_t>(places.places) : 1;
 
 	if (useExp) {
 		// Add space for the whole digit and the 'e'
 		len += 2;
 		// Show up to the specified number of decimal places.
-		len += places.places;
-		// Add space for the magnitude number and its sign.
-		len += lengthify_integral(magnitude,
-								  IOFormatBase::dec,
-								  IOFormatSign::always);
+		len += decimals;
+		/* Add space for the magnitude number and its sign. Rounding may
+		 * push the exponent one further from zero, so count that too. */
+		len += lengthify_integral(std::abs(magnitude) + 1) + 1;
 	} else {
 		// Add space for the whole part of the number.
-		len += lengthify_integral(static_cast<int>(floor(number)));
+		len += (number < 1) ? 1 : static_cast<size_t>(magnitude) + 1;
 		// Add space for the specified number of decimal places.
-		len += places.places;
+		len += decimals;
 	}
 
 	return len;
 }
 
-/* Convert an integer to a string
- * \param the integer to convert
- * \param the base for the conversion, default base-10
- * \param letter case to use for digits greater than 9
- * \param the notation to use for non-decimal bases.
- * \return the string representing the value.
+/** Write the digits of an unsigned integer from right to left, so the
+ * last digit lands just before `end`.
+ * Base 10 is written two digits at a time from a lookup table, and
+ * power-of-two bases use shifts and masks; only other bases divide.
+ * \param end: one past the last character to write
+ * \param number: the number to write
+ * \param base: the base to write in (2-36)
+ * \param digits: the digit characters to use (DIGIT_CHARS_*)
+ * \return pointer to the first written character
+ */
+template<typename U>
+char* _stringify_digits(char* end,
+						U number,
+						unsigned int base,
+						const char* digits)
+{
+	static_assert(std::is_unsigned<U>::value, "Must be an unsigned integer.");
+
+	char* pos = end;
+
+	if (base == 10) {
+		while (number >= 100) {
+			const size_t pair = static_cast<size_t>(number % 100) * 2;
+			number /= 100;
+			*--pos = DIGIT_PAIRS_DEC[pair + 1];
+			*--pos = DIGIT_PAIRS_DEC[pair];
+		}
+		if (number >= 10) {
+			const size_t pair = static_cast<size_t>(number) * 2;
+			*--pos = DIGIT_PAIRS_DEC[pair + 1];
+			*--pos = DIGIT_PAIRS_DEC[pair];
+		} else {
+			*--pos = static_cast<char>('0' + number);
+		}
+	} else if ((base & (base - 1)) == 0) {
+		// Each digit is exactly `shift` bits.
+		const unsigned int shift = __builtin_ctz(base);
+		const U mask = static_cast<U>(base - 1);
+		do {
+			*--pos = digits[number & mask];
+			number >>= shift;
+		} while (number);
+	} else {
+		do {
+			*--pos = digits[number % base];
+			number /= base;
+		} while (number);
+	}
+
+	return pos;
+}
+
+/** Convert an integer to a string, appending it to a buffer.
+ * \param buf: the buffer to append to
+ * \param val: the integer to convert
+ * \param base: the base for the conversion, default base-10
+ * \param sign: whether to always include the sign
+ * \param num_case: letter case to use for digits greater than 9
+ * \param notation: the notation to use for non-decimal bases.
  */
 template<typename T>
-std::string stringify_integral(
+void stringify_integral_to(
+	std::string& buf,
 	const T& val,
 	const IOFormatBase& base = IOFormatBase::dec,
 	const IOFormatSign& sign = IOFormatSign::automatic,
@@ -180,17 +344,32 @@ std::string stringify_integral(
 	   does not support multiple bases at this time. Therefore, a custom
 	   solution is called for. */
 
-	// If the number is zero, skip everything else and return that.
+	// If the number is zero, skip everything else and append that.
 	if (val == 0) {
-		return "0";
+		buf += '0';
+		return;
 	}
 
 	unsigned int _base = static_cast<unsigned int>(base);
 
-	/* Create a new string with a reserved length matching the expected
-	 * length of the string. */
-	std::string str = std::string();
-	str.reserve(lengthify_integral(val, base, sign));
+	/* Work on the absolute value as an unsigned integer, which also
+	 * safely handles the most negative value. */
+	using U = std::make_unsigned_t<T>;
+	bool negative = false;
+	U number = static_cast<U>(val);
+	if constexpr (std::is_signed<T>::value) {
+		if (val < 0) {
+			negative = true;
+			number = static_cast<U>(U(0) - number);
+		}
+	}
+
+	/* Build the string from right to left in a stack buffer, so we never
+	 * have to reverse it. The worst case is base 2, plus room for the
+	 * sign and the notation. */
+	char str[sizeof(T) * 8 + 4];
+	char* const end = str + sizeof(str);
+	char* pos = end;
 
 	bool prefix = false;
 
@@ -199,102 +378,301 @@ std::string stringify_integral(
 		 _base == 16)) {
 		prefix = true;
 	} else if (_base != 10 && notation != IOFormatBaseNotation::none) {
-		str += DIGIT_CHARS_LOWER[_base % 10];
+		// Subscript notation, such as "_7" or "_36", follows the digits.
+		*--pos = DIGIT_CHARS_LOWER[_base % 10];
 		if (_base > 10) {
-			str += DIGIT_CHARS_LOWER[_base / 10];
+			*--pos = DIGIT_CHARS_LOWER[_base / 10];
 		}
-		str += '_';
+		*--pos = '_';
 	}
 
-	/* Make a copy of the number for mutating.
-	 * If it's negative, make it positive. */
-	T number = (val >= 0) ? val : -val;
+	const char* digits = (num_case == IOFormatNumCase::lower)
+							 ? DIGIT_CHARS_LOWER
+							 : DIGIT_CHARS_UPPER;
 
-	while (number) {
-		size_t digit = number % _base;
-		switch (num_case) {
-			case IOFormatNumCase::lower:
-				str += DIGIT_CHARS_LOWER[digit];
-				break;
-			case IOFormatNumCase::upper:
-				str += DIGIT_CHARS_UPPER[digit];
-				break;
-		}
-		number /= _base;
-	}
+	pos = _stringify_digits(pos, number, _base, digits);
 
 	if (prefix) {
 		switch (_base) {
 			case 2:
-				str += 'b';
+				*--pos = 'b';
 				break;
 			case 3:
-				str += 't';
+				*--pos = 't';
 				break;
 			case 8:
-				str += 'o';
+				*--pos = 'o';
 				break;
 			case 12:
-				str += 'z';
+				*--pos = 'z';
 				break;
 			case 16:
-				str += 'x';
+				*--pos = 'x';
 				break;
 		}
-		str += '0';
+		*--pos = '0';
 	}
 
-	if (val < 0) {
-		str += "-";
+	if (negative) {
+		*--pos = '-';
 	} else if (sign == IOFormatSign::always) {
-		str += "+";
+		*--pos = '+';
 	}
 
-	return reversify(str);
+	buf.append(pos, static_cast<size_t>(end - pos));
 }
 
-inline std::string stringify_char(
-	const char& val, const IOFormatCharValue& as = IOFormatCharValue::as_char)
+/* Convert an integer to a string
+ * \param the integer to convert
+ * \param the base for the conversion, default base-10
+ * \param letter case to use for digits greater than 9
+ * \param the notation to use for non-decimal bases.
+ * \return the string representing the value.
+ */
+template<typename T>
+std::string stringify_integral(
+	const T& val,
+	const IOFormatBase& base = IOFormatBase::dec,
+	const IOFormatSign& sign = IOFormatSign::automatic,
+	const IOFormatNumCase& num_case = IOFormatNumCase::upper,
+	const IOFormatBaseNotation& notation = IOFormatBaseNotation::prefix)
+{
+	std::string str = std::string();
+	stringify_integral_to(str, val, base, sign, num_case, notation);
+	return str;
+}
+
+/** Convert a char to a string, appending it to a buffer.
+ * \param buf: the buffer to append to
+ * \param val: the character to convert
+ * \param as: whether to show the character, or its integer value
+ */
+inline void stringify_char_to(
+	std::string& buf,
+	const char& val,
+	const IOFormatCharValue& as = IOFormatCharValue::as_char)
 {
 	switch (as) {
 		case IOFormatCharValue::as_char:
-			return std::string(1, val);
+			buf += val;
+			break;
 		case IOFormatCharValue::as_int:
-			return stringify_integral(val, IOFormatBase::dec);
+			stringify_integral_to(buf, val, IOFormatBase::dec);
+			break;
 	}
-	return "";
 }
 
-/**Convert a floating point number to a string.
- * \param the number to convert to a string
- * \param the number of decimal places (default 14)
- * \param whether to use scientific notation
- * \return the string representing the value. */
+inline std::string stringify_char(
+	const char& val, const IOFormatCharValue& as = IOFormatCharValue::as_char)
+{
+	std::string str = std::string();
+	stringify_char_to(str, val, as);
+	return str;
+}
+
+/** Append scientific notation's exponent, such as "e+5" or "e-12".
+ * \param buf: the buffer to append to
+ * \param exponent: the exponent
+ */
+inline void _stringify_exponent_to(std::string& buf, int exponent)
+{
+	buf += 'e';
+	// The sign is always shown, even for zero.
+	buf += (exponent < 0) ? '-' : '+';
+	stringify_integral_to(buf, (exponent < 0) ? -exponent : exponent);
+}
+
+/** Find the shortest string of significant digits which reads back as
+ * exactly the same (non-negative, finite) floating-point number.
+ * \param number: the number to convert
+ * \param digits: receives the digits, without a decimal point; must hold
+ * at least std::numeric_limits<T>::max_digits10 characters
+ * \param exponent: receives the base-10 exponent of the first digit
+ * \return the number of digits
+ */
 template<typename T>
-std::string stringify_floating_point(
+size_t _stringify_shortest_digits(T number, char* digits, int& exponent)
+{
+	// Room for "d.<digits>e-XXXX" at any precision.
+	char sci[std::numeric_limits<T>::max_digits10 + 16];
+	char* end = sci;
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	/* Without a precision, to_chars() already produces the shortest
+	 * round-trip representation. */
+	end = std::to_chars(sci,
+						sci + sizeof(sci),
+						number,
+						std::chars_format::scientific)
+			  .ptr;
+#else
+	// Fallback: try each precision until the string reads back exactly.
+	for (int precision = 0; precision < std::numeric_limits<T>::max_digits10;
+		 ++precision) {
+		int len = snprintf(sci,
+						   sizeof(sci),
+						   "%.*Le",
+						   precision,
+						   static_cast<long double>(number));
+		end = sci + len;
+
+		// Read back at the same precision, to avoid double rounding.
+		T parsed = 0;
+		if constexpr (std::is_same<T, float>::value) {
+			parsed = strtof(sci, nullptr);
+		} else if constexpr (std::is_same<T, double>::value) {
+			parsed = strtod(sci, nullptr);
+		} else {
+			parsed = strtold(sci, nullptr);
+		}
+
+		if (parsed == number) {
+			break;
+		}
+	}
+#endif
+
+	// Gather the significant digits, skipping any sign and the decimal point.
+	const char* pos = sci;
+	size_t len = 0;
+	for (; pos < end && *pos != 'e'; ++pos) {
+		if (*pos != '.' && *pos != '-') {
+			digits[len++] = *pos;
+		}
+	}
+
+	// Trailing zeros aren't significant.
+	while (len > 1 && digits[len - 1] == '0') {
+		--len;
+	}
+
+	// Read the exponent, which always has a sign.
+	exponent = 0;
+	if (pos < end) {
+		++pos;
+		bool negative = (*pos == '-');
+		for (++pos; pos < end; ++pos) {
+			exponent = exponent * 10 + (*pos - '0');
+		}
+		if (negative) {
+			exponent = -exponent;
+		}
+	}
+
+	return len;
+}
+
+/** Convert a floating point number to a string, appending it to a buffer,
+ * using the shortest digits which read back as exactly the same value.
+ * \param buf: the buffer to append to
+ * \param number: the absolute value of the number to convert
+ * \param sci: whether to use scientific notation
+ */
+template<typename T>
+void _stringify_floating_point_shortest_to(std::string& buf,
+										   T number,
+										   const IOFormatSciNotation& sci)
+{
+	char digits[std::numeric_limits<T>::max_digits10 + 1];
+	int exponent = 0;
+	const size_t len = _stringify_shortest_digits(number, digits, exponent);
+
+	bool useExp = false;
+	switch (sci) {
+		case IOFormatSciNotation::always:
+			useExp = true;
+			break;
+		case IOFormatSciNotation::automatic:
+			useExp = (exponent > 12 || exponent < -5);
+			break;
+		case IOFormatSciNotation::never:
+		default:
+			break;
+	}
+
+	if (useExp) {
+		// D.NNNN form, always with at least one decimal place.
+		buf += digits[0];
+		buf += '.';
+		if (len > 1) {
+			buf.append(digits + 1, len - 1);
+		} else {
+			buf += '0';
+		}
+
+		// Add scientific notation at end
+		_stringify_exponent_to(buf, exponent);
+	} else if (exponent < 0) {
+		// 0.000NNNN form.
+		buf += "0.";
+		buf.append(static_cast<size_t>(-exponent - 1), '0');
+		buf.append(digits, len);
+	} else {
+		// The whole part, padded with zeros if the digits run out first.
+		const size_t whole = static_cast<size_t>(exponent) + 1;
+		if (len <= whole) {
+			buf.append(digits, len);
+			buf.append(whole - len, '0');
+			buf += ".0";
+		} else {
+			buf.append(digits, whole);
+			buf += '.';
+			buf.append(digits + whole, len - whole);
+		}
+	}
+}
+
+/**Convert a floating point number to a string, appending it to a buffer.
+ * \param buf: the buffer to append to
+ * \param val: the number to convert to a string
+ * \param places: the number of decimal places (default 14)
+ * \param sci: whether to use scientific notation
+ * \param sign: whether to always include the sign
+ */
+template<typename T>
+void stringify_floating_point_to(
+	std::string& buf,
 	const T& val,
 	const IOFormatDecimalPlaces& places = IOFormatDecimalPlaces(14),
 	const IOFormatSciNotation& sci = IOFormatSciNotation::automatic,
 	const IOFormatSign& sign = IOFormatSign::automatic)
 {
-	/* Create a new string with a reserved length matching the expected
-	 * length of the string. */
-	std::string str = std::string();
-	str.reserve(lengthify_integral(val, IOFormatBase::dec, sign));
+	// Get the absolute value of the number, which drops the sign of -0.0.
+	T number = std::fabs(val);
 
-	// Get the absolute value of the number.
-	T number = (val >= 0) ? val : -val;
+	// Not-a-number has no sign, and neither it nor infinity has digits.
+	if (std::isnan(val)) {
+		buf += "nan";
+		return;
+	}
 
-	int magnitude = 0;
+	// Append appropriate sign, including for negative zero.
+	if (std::signbit(val)) {
+		buf += '-';
+	} else if (sign == IOFormatSign::always) {
+		buf += '+';
+	}
+
+	if (std::isinf(val)) {
+		buf += "inf";
+		return;
+	}
+
+	if (places.places == IOFormatDecimalPlaces::shortest) {
+		_stringify_floating_point_shortest_to(buf, number, sci);
+		return;
+	}
+
+	// The exponent of the leading digit. Zero has no logarithm.
+	int magnitude =
+		(number == 0) ? 0 : static_cast<int>(floor(log10(number)));
 	bool useExp = false;
 
 	switch (sci) {
 		case IOFormatSciNotation::always:
-			magnitude = log10(number);
 			useExp = true;
 			break;
 		case IOFormatSciNotation::automatic:
-			magnitude = log10(number);
 			useExp = (magnitude > 12 || magnitude < -5);
 			break;
 		case IOFormatSciNotation::never:
@@ -303,37 +681,72 @@ std::string stringify_floating_point(
 			break;
 	}
 
-	// Append appropriate sign
-	if (val < 0) {
-		str += '-';
-	} else if (sign == IOFormatSign::always) {
-		str += '+';
-	}
-
 	if (useExp) {
-		// Modify to D.NNNNNNNN form and convert that to a string.
-		T modified = number * pow(10, -(ceil(log10(number))) + 1);
-		str += stringify_floating_point(modified,
-										places,
-										IOFormatSciNotation::never);
+		/* Modify to D.NNNNNNNN form. Scale in two steps for the smallest
+		 * numbers, where the power of ten alone would overflow. */
+		T modified = number;
+		int scale = magnitude;
+		if (scale < std::numeric_limits<T>::min_exponent10) {
+			modified *= pow(T(10), -std::numeric_limits<T>::min_exponent10);
+			scale -= std::numeric_limits<T>::min_exponent10;
+		}
+		modified *= pow(T(10), -scale);
+
+		// Correct for any rounding error in the logarithm.
+		if (modified >= 10) {
+			modified /= 10;
+			++magnitude;
+		} else if (modified < 1 && modified > 0) {
+			modified *= 10;
+			--magnitude;
+		}
+
+		stringify_floating_point_to(buf,
+									modified,
+									places,
+									IOFormatSciNotation::never);
 
 		// Add scientific notation at end
-		str += 'e';
-		std::string str_mag = stringify_integral(magnitude,
-												 IOFormatBase::dec,
-												 IOFormatSign::always);
-		str += str_mag;
+		_stringify_exponent_to(buf, magnitude);
 	} else {
 		// Get whole part
-		long long int whole = static_cast<int>(floor(number));
-		str += stringify_integral(whole);
+		T whole_part = floor(number);
+
+		/* If the whole part is too large for an integer, there's no
+		 * fractional part left to show, so write its exact digits.
+		 * (2^64 is exactly representable in any floating-point type.) */
+		if (whole_part >= static_cast<T>(18446744073709551616.0L)) {
+			char str[std::numeric_limits<T>::max_exponent10 + 8];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+			buf.append(str,
+					   std::to_chars(str,
+									 str + sizeof(str),
+									 whole_part,
+									 std::chars_format::fixed,
+									 0)
+						   .ptr);
+#else
+			buf.append(str,
+					   snprintf(str,
+								sizeof(str),
+								"%.0Lf",
+								static_cast<long double>(whole_part)));
+#endif
+			buf += '.';
+			buf.append(places.places, '0');
+			return;
+		}
+
+		unsigned long long int whole =
+			static_cast<unsigned long long int>(whole_part);
+		stringify_integral_to(buf, whole);
 
 		// Append decimal character
-		str += '.';
+		buf += '.';
 
 		// Get decimal part
 		long long int decimal =
-			floor((number - whole) * pow(10, places.places));
+			floor((number - whole_part) * pow(10, places.places));
 
 		// decimal var length.
 		const int decimal_len = lengthify_integral(decimal);
@@ -341,17 +754,28 @@ std::string stringify_floating_point(
 		// If decimal len is lower than the amount of places, the following
 		// block code is executed.
 		if (decimal_len < places.places) {
-			int missing_places = places.places - decimal_len;
-
-			// For loop which appends the missing 0's to the string.
-			for (int i = 0; i < missing_places; ++i) {
-				str += '0';
-			}
+			// Append the missing 0's to the string.
+			buf.append(places.places - decimal_len, '0');
 		}
 
-		str += stringify_integral(decimal);
+		stringify_integral_to(buf, decimal);
 	}
+}
 
+/**Convert a floating point number to a string.
+ * \param the number to convert to a string
+ * \param the number of decimal places (default 14)
+ * \param whether to use scientific notation
+ * \return the string representing the value. */
+template<typename T>
+std::string stringify_floating_point(
+	const T& val,
+	const IOFormatDecimalPlaces& places = IOFormatDecimalPlaces(14),
+	const IOFormatSciNotation& sci = IOFormatSciNotation::automatic,
+	const IOFormatSign& sign = IOFormatSign::automatic)
+{
+	std::string str = std::string();
+	stringify_floating_point_to(str, val, places, sci, sign);
 	return str;
 }
 
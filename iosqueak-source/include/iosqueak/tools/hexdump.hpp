@@ -0,0 +1,147 @@
+/** HexDump [IOSqueak]
+ * Version: 1.0
+ *
+ * Formats memory in the classic offset, hex, and ASCII layout of
+ * `hexdump -C`, one row at a time, reading straight from the source so
+ * that large regions can be dumped without copying them.
+ *
+ * Author: Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_HEXDUMP_HPP
+#define IOSQUEAK_HEXDUMP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+#include "iosqueak/channel.hpp"
+#include "iosqueak/ioformat.hpp"
+#include "iosqueak/tools/memlens.hpp"
+
+class HexDump
+{
+public:
+	/// Receives each row of the dump, including its trailing newline.
+	using sink = std::function<void(std::string_view)>;
+
+	/// The widest row allowed, in bytes.
+	static constexpr size_t MAX_WIDTH = 32;
+
+protected:
+	/// The number of bytes on each row.
+	size_t width;
+	/// Whether runs of identical rows are collapsed to a single `*`.
+	bool collapse;
+	/// The case of the hex digits.
+	IOFormatNumCase num_case;
+	/// The offset printed for the first byte.
+	uint64_t origin;
+
+	/** Format a single row into a buffer.
+	 * \param buf: the buffer, large enough for a row of MAX_WIDTH bytes
+	 * \param row: the first byte of the row
+	 * \param count: the number of bytes on the row (at most the width)
+	 * \param offset: the offset of the first byte
+	 * \param digits: the number of digits in the offset column
+	 * \return the number of characters written
+	 */
+	size_t format_row(char* buf,
+					  const uint8_t* row,
+					  size_t count,
+					  uint64_t offset,
+					  int digits) const;
+
+public:
+	/** Create a formatter.
+	 * Throws std::invalid_argument if the width is not 16 or 32.
+	 * \param row_width: the number of bytes on each row (16 or 32)
+	 * \param collapse_repeats: whether to collapse runs of identical rows
+	 * \param digit_case: the case of the hex digits
+	 */
+	explicit HexDump(size_t row_width = 16,
+					 bool collapse_repeats = true,
+					 IOFormatNumCase digit_case = IOFormatNumCase::lower);
+
+	/** Set the offset printed for the first byte, such as the address of
+	 * the region or its position in a file. Defaults to 0.
+	 * \param offset: the starting offset
+	 * \return a reference to the formatter
+	 */
+	HexDump& start_at(uint64_t offset);
+
+	/** Dump a region, passing each row to a sink as it is formatted.
+	 * Only one row is ever held in memory, so regions of any size can be
+	 * dumped. The last row is the offset just past the end.
+	 * \param data: the start of the region
+	 * \param len: the number of bytes to dump
+	 * \param out: the sink to receive the rows
+	 */
+	void dump(const void* data, size_t len, const sink& out) const;
+
+	/** Dump a region to a channel, transmitting each row as it is
+	 * formatted. Set the verbosity and category on the channel first;
+	 * they apply to every row.
+	 * \param data: the start of the region
+	 * \param len: the number of bytes to dump
+	 * \param chan: the channel to transmit to
+	 */
+	void dump(const void* data, size_t len, Channel& chan = ::channel) const;
+
+	/** Dump a span, such as the view of a MemLens, passing each row to
+	 * a sink as it is formatted.
+	 * \param bytes: the bytes to dump
+	 * \param out: the sink to receive the rows
+	 */
+	void dump(MemSpan bytes, const sink& out) const
+	{
+		dump(bytes.data(), bytes.size(), out);
+	}
+
+	/** Dump a span, such as the view of a MemLens, to a channel.
+	 * \param bytes: the bytes to dump
+	 * \param chan: the channel to transmit to
+	 */
+	void dump(MemSpan bytes, Channel& chan = ::channel) const
+	{
+		dump(bytes.data(), bytes.size(), chan);
+	}
+};
+
+#endif
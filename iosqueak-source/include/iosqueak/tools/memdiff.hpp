@@ -0,0 +1,161 @@
+/** MemDiff [IOSqueak]
+ * Version: 1.0
+ *
+ * Takes successive snapshots of the region in a MemLens, and reports the
+ * byte ranges which changed between them, dumping only the rows which
+ * differ.
+ *
+ * Author: Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_MEMDIFF_HPP
+#define IOSQUEAK_MEMDIFF_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "iosqueak/channel.hpp"
+#include "iosqueak/ioformat.hpp"
+#include "iosqueak/tools/memlens.hpp"
+
+class MemDiff
+{
+public:
+	/// A run of changed bytes.
+	struct Range {
+		/// The offset of the first changed byte from the start of the region.
+		size_t offset;
+		/// The number of changed bytes.
+		size_t length;
+	};
+
+	/// Receives each line of the dump, including its trailing newline.
+	using sink = std::function<void(std::string_view)>;
+
+protected:
+	/// The lens on the region being watched.
+	const MemLens& lens;
+	/// The snapshot before the latest one.
+	std::vector<uint8_t> before;
+	/// The latest snapshot.
+	std::vector<uint8_t> after;
+	/// The changes between the two snapshots, in order.
+	std::vector<Range> ranges;
+
+	/// The number of bytes on each row of the dump.
+	size_t width;
+	/// The color of changed bytes in the dump.
+	IOFormatTextFG highlight;
+
+	/// Receives each run of a dumped row, and whether its bytes changed.
+	using run_sink = std::function<void(std::string_view, bool)>;
+
+	/** Format the rows containing changes, passing the text on in runs.
+	 * Each row ends with a run holding only its newline.
+	 * \param out: the sink to receive the runs
+	 */
+	void dump_runs(const run_sink& out) const;
+
+public:
+	/** Start watching the region in a lens, taking the first snapshot.
+	 * The lens must outlive the diff. It should be in view mode, or be a
+	 * DynamicMemLens; a shared or weak lens in snapshot mode doesn't hold
+	 * its region, so there is nothing live to compare.
+	 * Throws std::invalid_argument if the width is not 16 or 32.
+	 * \param watch: the lens on the region to watch
+	 * \param row_width: the number of bytes on each row (16 or 32)
+	 * \param color: the color of changed bytes in the dump
+	 */
+	explicit MemDiff(const MemLens& watch,
+					 size_t row_width = 16,
+					 IOFormatTextFG color = IOFormatTextFG::red);
+
+	// A temporary lens wouldn't outlive the diff.
+	MemDiff(MemLens&&,
+			size_t = 16,
+			IOFormatTextFG = IOFormatTextFG::red) = delete;
+
+	MemDiff(const MemDiff&) = delete;
+	MemDiff& operator=(const MemDiff&) = delete;
+
+	/** Take a new snapshot and compare it to the previous one.
+	 * \return the changed ranges
+	 */
+	const std::vector<Range>& update();
+
+	/// \return the ranges which changed at the last update()
+	const std::vector<Range>& changes() const { return ranges; }
+
+	/// \return true if anything changed at the last update(), else false
+	bool changed() const { return !ranges.empty(); }
+
+	/// \return the snapshot before the latest one
+	MemSpan previous() const { return MemSpan(before); }
+
+	/// \return the latest snapshot
+	MemSpan current() const { return MemSpan(after); }
+
+	/** Find the runs of bytes which differ between two regions. If one
+	 * region is longer, its extra bytes count as changed.
+	 * \param lhs: the first region
+	 * \param rhs: the second region
+	 * \param out: the vector to store the ranges in, in order
+	 */
+	static void compare(MemSpan lhs, MemSpan rhs, std::vector<Range>& out);
+
+	/** Dump the rows containing changes, passing each line to a sink.
+	 * Each such row is shown as it was (marked `-`) and as it is now
+	 * (marked `+`), with the changed bytes highlighted.
+	 * \param out: the sink to receive the lines
+	 * \param standard: the formatting standard for the highlighting
+	 */
+	void dump(const sink& out,
+			  IOFormatStandard standard = IOFormatStandard::ansi) const;
+
+	/** Dump the rows containing changes to a channel, one transmission
+	 * per line. The highlighting follows the channel's formatting standard,
+	 * and each changed byte returns to the message's current color.
+	 * \param chan: the channel to transmit to
+	 */
+	void dump(Channel& chan = ::channel) const;
+};
+
+#endif
@@ -57,6 +57,48 @@
 
 enum class PtrType { raw, shared, weak };
 
+/// Whether a MemLens reads live memory, or a copy taken when it is created.
+enum class LensMode { view, snapshot };
+
+/** A read-only view of a contiguous run of bytes. This stands in for
+ * std::span<const uint8_t>, which is not available before C++20.
+ */
+class MemSpan
+{
+protected:
+	const uint8_t* first;
+	size_t length;
+
+public:
+	constexpr MemSpan() : first(nullptr), length(0) {}
+
+	constexpr MemSpan(const uint8_t* data, size_t size)
+	: first(data), length(size)
+	{
+	}
+
+	// Implicit, so a vector can be passed anywhere a span is expected.
+	MemSpan(const std::vector<uint8_t>& bytes)
+	: first(bytes.data()), length(bytes.size())
+	{
+	}
+
+	constexpr const uint8_t* data() const { return first; }
+
+	constexpr size_t size() const { return length; }
+
+	constexpr bool empty() const { return length == 0; }
+
+	constexpr const uint8_t* begin() const { return first; }
+
+	constexpr const uint8_t* end() const { return first + length; }
+
+	constexpr const uint8_t& operator[](size_t index) const
+	{
+		return first[index];
+	}
+};
+
 // NOTE: We cannot support unique_ptr because it cannot be copied.
 
 class MemLens
@@ -66,7 +108,12 @@ protected:
 	size_t size;
 	std::type_index type;
 	PtrType ptr_type;
-	std::vector<uint8_t> snapshot;
+	/// Keeps a shared region alive for as long as it is being viewed.
+	std::shared_ptr<const void> owner;
+	/// The copy of the region, if one has been taken.
+	std::vector<uint8_t> frozen;
+	/// Whether the copy has been taken.
+	bool captured;
 
 	void take_snapshot()
 	{
@@ -75,81 +122,115 @@ protected:
 		}
 
 		const uint8_t* root = reinterpret_cast<const uint8_t*>(focus);
-
-		for (uint8_t lens = 0; lens < size; ++lens) {
-			this->snapshot.push_back(*(root + lens));
-		}
+		this->frozen.assign(root, root + size);
+		this->captured = true;
 	}
 
 public:
+	/** Focus on a region of memory at a void pointer.
+	 * CAUTION: In view mode, the region must outlive the lens.
+	 * \param ptr: the start of the region
+	 * \param readsize: the number of bytes in the region
+	 * \param mode: whether to view the live memory or copy it now
+	 */
 	explicit MemLens(const void* ptr,
-					 const IOMemReadSize& readsize = IOMemReadSize(1))
+					 const IOMemReadSize& readsize = IOMemReadSize(1),
+					 LensMode mode = LensMode::view)
 	: focus(ptr), size(readsize.readsize), type(std::type_index(typeid(void))),
-	  ptr_type(PtrType::raw)
+	  ptr_type(PtrType::raw), captured(false)
 	{
-		this->snapshot.reserve(size);
-		this->take_snapshot();
+		if (mode == LensMode::snapshot) {
+			this->take_snapshot();
+		}
 	}
 
 	template<typename T>
-	explicit MemLens(const T* ptr)
+	explicit MemLens(const T* ptr, LensMode mode = LensMode::view)
 	: focus(reinterpret_cast<const void*>(ptr)), size(sizeof(T)),
-	  type(std::type_index(typeid(T))), ptr_type(PtrType::raw)
+	  type(std::type_index(typeid(T))), ptr_type(PtrType::raw),
+	  captured(false)
 	{
-		this->snapshot.reserve(size);
-		this->take_snapshot();
+		if (mode == LensMode::snapshot) {
+			this->take_snapshot();
+		}
 	}
 
+	/** Focus on a region of memory owned by a shared pointer. In view mode,
+	 * the lens shares ownership, so the region outlives it.
+	 * \param ptr: the shared pointer to the region
+	 * \param readsize: the number of bytes in the region
+	 * \param mode: whether to view the live memory or copy it now
+	 */
 	explicit MemLens(const std::shared_ptr<void>& ptr,
-					 const IOMemReadSize& readsize = IOMemReadSize(1))
+					 const IOMemReadSize& readsize = IOMemReadSize(1),
+					 LensMode mode = LensMode::view)
 	: focus(ptr.get()), size(readsize.readsize),
-	  type(std::type_index(typeid(void))), ptr_type(PtrType::shared)
+	  type(std::type_index(typeid(void))), ptr_type(PtrType::shared),
+	  captured(false)
 	{
-		this->snapshot.reserve(size);
-		this->take_snapshot();
+		if (mode == LensMode::snapshot) {
+			this->take_snapshot();
+		} else {
+			this->owner = ptr;
+		}
 	}
 
 	template<typename T>
-	explicit MemLens(const std::shared_ptr<T>& ptr)
+	explicit MemLens(const std::shared_ptr<T>& ptr,
+					 LensMode mode = LensMode::view)
 	: focus(ptr.get()), size(sizeof(T)), type(std::type_index(typeid(T))),
-	  ptr_type(PtrType::shared)
+	  ptr_type(PtrType::shared), captured(false)
 	{
-		this->snapshot.reserve(size);
-		this->take_snapshot();
+		if (mode == LensMode::snapshot) {
+			this->take_snapshot();
+		} else {
+			this->owner = ptr;
+		}
 	}
 
+	/** Focus on a region of memory referred to by a weak pointer. In view
+	 * mode, the lens shares ownership if the region still exists.
+	 * \param ptr: the weak pointer to the region
+	 * \param readsize: the number of bytes in the region
+	 * \param mode: whether to view the live memory or copy it now
+	 */
 	explicit MemLens(const std::weak_ptr<void>& ptr,
-					 const IOMemReadSize& readsize = IOMemReadSize(1))
+					 const IOMemReadSize& readsize = IOMemReadSize(1),
+					 LensMode mode = LensMode::view)
 	: focus(nullptr), size(readsize.readsize),
-	  type(std::type_index(typeid(void))), ptr_type(PtrType::weak)
+	  type(std::type_index(typeid(void))), ptr_type(PtrType::weak),
+	  captured(false)
 	{
-		this->snapshot.reserve(size);
-
-		if (!ptr.expired()) {
-			// Steal the raw pointer out of the weak pointer.
-			auto shared = ptr.lock();
-			focus = shared.get();
+		// Hold the region while we focus on it.
+		auto shared = ptr.lock();
+		focus = shared.get();
+
+		if (mode == LensMode::snapshot) {
+			this->take_snapshot();
+		} else {
+			this->owner = std::move(shared);
 		}
-
-		this->take_snapshot();
 	}
 
 	template<typename T>
-	explicit MemLens(const std::weak_ptr<T>& ptr)
+	explicit MemLens(const std::weak_ptr<T>& ptr,
+					 LensMode mode = LensMode::view)
 	: focus(nullptr), size(sizeof(T)), type(std::type_index(typeid(T))),
-	  ptr_type(PtrType::weak)
+	  ptr_type(PtrType::weak), captured(false)
 	{
-		this->snapshot.reserve(size);
-
-		if (!ptr.expired()) {
-			// Steal the raw pointer out of the weak pointer.
-			auto shared = ptr.lock();
-			focus = shared.get();
+		// Hold the region while we focus on it.
+		auto shared = ptr.lock();
+		focus = shared.get();
+
+		if (mode == LensMode::snapshot) {
+			this->take_snapshot();
+		} else {
+			this->owner = std::move(shared);
 		}
-
-		this->take_snapshot();
 	}
 
+	virtual ~MemLens() = default;
+
 	uint64_t address() const { return reinterpret_cast<uint64_t>(focus); }
 
 	size_t data_size() const { return size; }
@@ -157,8 +238,57 @@ public:
 	// TODO: Can we return ref?
 	std::type_index data_type() const { return type; }
 
-	// TODO: Can we return ref?
-	virtual std::vector<uint8_t> memory() const { return this->snapshot; }
+	/** View the region without copying it. This is the snapshot, if one
+	 * has been taken, or else the live memory.
+	 * \return the bytes of the region, or an empty span if there are none
+	 */
+	virtual MemSpan view() const
+	{
+		if (this->captured) {
+			return MemSpan(this->frozen);
+		}
+		return this->live();
+	}
+
+	/** View the live memory, even if a snapshot has been taken.
+	 * A region from a shared or weak pointer can only be viewed while the
+	 * lens holds it, which it does only in view mode.
+	 * \return the bytes of the region, or an empty span if there are none
+	 */
+	virtual MemSpan live() const
+	{
+		if (this->focus == nullptr ||
+			(this->ptr_type != PtrType::raw && this->owner == nullptr)) {
+			return MemSpan();
+		}
+		return MemSpan(reinterpret_cast<const uint8_t*>(focus), size);
+	}
+
+	/** Copy the live memory, even if a snapshot has been taken.
+	 * \param out: the vector to copy into, replacing its contents; it is
+	 * left empty if there is nothing to read
+	 */
+	virtual void read_live(std::vector<uint8_t>& out) const
+	{
+		MemSpan bytes = this->live();
+		out.assign(bytes.begin(), bytes.end());
+	}
+
+	/** Copy the region as it is now. Afterwards, view() and memory()
+	 * return the copy instead of the live memory. May be called again
+	 * to replace the copy.
+	 */
+	void snapshot() { this->take_snapshot(); }
+
+	/// \return true if a snapshot has been taken, else false
+	bool has_snapshot() const { return this->captured; }
+
+	/// \return a copy of the bytes in view()
+	virtual std::vector<uint8_t> memory() const
+	{
+		MemSpan bytes = this->view();
+		return std::vector<uint8_t>(bytes.begin(), bytes.end());
+	}
 
 	PtrType pointer_type() const { return ptr_type; }
 };
@@ -171,27 +301,40 @@ protected:
 
 public:
 	explicit DynamicMemLens(const std::shared_ptr<T> ptr)
-	: handle(ptr), MemLens(ptr)
+	: MemLens(ptr, LensMode::snapshot), handle(ptr)
 	{
 	}
 
 	explicit DynamicMemLens(const std::weak_ptr<T> ptr)
-	: handle(ptr), MemLens(ptr)
+	: MemLens(ptr, LensMode::snapshot), handle(ptr)
 	{
 	}
 
-	virtual std::vector<uint8_t> memory() const override
+	virtual MemSpan view() const override
 	{
 		if (this->handle.expired()) {
-			return std::vector<uint8_t>();
+			return MemSpan();
 		}
 
 		/* NOTE: I used to take a snapshot here, but that violated const
 		 * indirectly. Therefore, I just won't retake it here; it will only
 		 * be taken automatically at constructor, or else explicitly by the
-		 * user.
+		 * user with snapshot().
 		 */
-		return this->snapshot;
+		return MemLens::view();
+	}
+
+	/* The lens doesn't hold the region, so live() is always empty.
+	 * This holds it just long enough to copy it. */
+	virtual void read_live(std::vector<uint8_t>& out) const override
+	{
+		std::shared_ptr<T> pinned = this->handle.lock();
+		if (pinned == nullptr) {
+			out.clear();
+			return;
+		}
+		const uint8_t* root = reinterpret_cast<const uint8_t*>(pinned.get());
+		out.assign(root, root + this->size);
 	}
 };
 
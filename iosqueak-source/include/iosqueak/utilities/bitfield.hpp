@@ -47,23 +47,23 @@
 /** Convert a struct to a bitfield by generating the bitwise operators.
  *  \param T: the struct (type) to generate operators for.
  */
-#define MAKE_BITFIELD(T)                                            \
-	inline T operator&(const T& lhs, const T& rhs)                  \
-	{                                                               \
-		return flags_and(lhs, rhs);                                 \
-	}                                                               \
-                                                                    \
-	inline T operator|(const T& lhs, const T& rhs)                  \
-	{                                                               \
-		return flags_or(lhs, rhs);                                  \
-	}                                                               \
-                                                                    \
-	inline T operator^(const T& lhs, const T& rhs)                  \
-	{                                                               \
-		return flags_xor(lhs, rhs);                                 \
-	}                                                               \
-                                                                    \
-	inline T operator~(const T& lhs) { return flags_twiddle(lhs); } \
+#define MAKE_BITFIELD(T)                                                      \
+	inline constexpr T operator&(const T& lhs, const T& rhs)                  \
+	{                                                                         \
+		return flags_and(lhs, rhs);                                           \
+	}                                                                         \
+                                                                              \
+	inline constexpr T operator|(const T& lhs, const T& rhs)                  \
+	{                                                                         \
+		return flags_or(lhs, rhs);                                            \
+	}                                                                         \
+                                                                              \
+	inline constexpr T operator^(const T& lhs, const T& rhs)                  \
+	{                                                                         \
+		return flags_xor(lhs, rhs);                                           \
+	}                                                                         \
+                                                                              \
+	inline constexpr T operator~(const T& lhs) { return flags_twiddle(lhs); } \
 	asm("")  // swallow the semicolon
 
 /** Perform bitwise AND on a bitfield.
@@ -72,7 +72,7 @@
  * \return the result of the bitwise operation as a bitfield.
  */
 template<typename T>
-T flags_and(const T& lhs, const T& rhs)
+constexpr T flags_and(const T& lhs, const T& rhs)
 {
 	return static_cast<T>(static_cast<int>(lhs) & static_cast<int>(rhs));
 }
@@ -83,7 +83,7 @@ T flags_and(const T& lhs, const T& rhs)
  * \return the result of the bitwise operation as a bitfield.
  */
 template<typename T>
-T flags_or(const T& lhs, const T& rhs)
+constexpr T flags_or(const T& lhs, const T& rhs)
 {
 	return static_cast<T>(static_cast<int>(lhs) | static_cast<int>(rhs));
 }
@@ -94,7 +94,7 @@ T flags_or(const T& lhs, const T& rhs)
  * \return the result of the bitwise operation as a bitfield.
  */
 template<typename T>
-T flags_xor(const T& lhs, const T& rhs)
+constexpr T flags_xor(const T& lhs, const T& rhs)
 {
 	return static_cast<T>(static_cast<int>(lhs) ^ static_cast<int>(rhs));
 }
@@ -104,7 +104,7 @@ T flags_xor(const T& lhs, const T& rhs)
  * \return the result of the bitwise operation as a bitfield.
  */
 template<typename T>
-T flags_twiddle(const T& rhs)
+constexpr T flags_twiddle(const T& rhs)
 {
 	return static_cast<T>(~static_cast<int>(rhs));
 }
@@ -115,7 +115,7 @@ T flags_twiddle(const T& rhs)
  * \return true if flag is found in bitfield, else false
  */
 template<typename T>
-bool flags_check(const T& field, const T& value)
+constexpr bool flags_check(const T& field, const T& value)
 {
 	return static_cast<bool>(field & value);
 }
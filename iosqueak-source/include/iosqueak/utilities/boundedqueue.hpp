@@ -0,0 +1,200 @@
+/** BoundedQueue [IOSqueak]
+ * Version: 1.0
+ *
+ * A fixed-capacity, lock-free, multi-producer queue, used for handing
+ * finished messages from any number of threads to a single writer.
+ *
+ * Based on Dmitry Vyukov's bounded MPMC queue. Consumers are also safe to
+ * run concurrently, which allows producers to discard the oldest element
+ * when the queue is full.
+ *
+ * Author: Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2016-2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_BOUNDEDQUEUE_HPP
+#define IOSQUEAK_BOUNDEDQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+template<typename T>
+class BoundedQueue
+{
+protected:
+	/// A single slot, tagged with a sequence number for synchronization.
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	// Avoiding magic numbers (typical cache line size).
+	static constexpr size_t CACHE_LINE = 64;
+
+	/// The slots. Capacity is always a power of two.
+	std::unique_ptr<Cell[]> cells;
+	/// Capacity - 1, for cheap modulo.
+	const size_t mask;
+
+	// Keep the two cursors on separate cache lines to avoid false sharing.
+	alignas(CACHE_LINE) std::atomic<size_t> enqueue_pos;
+	alignas(CACHE_LINE) std::atomic<size_t> dequeue_pos;
+
+	/** Round up to the next power of two (minimum 2).
+	 * \param val: the requested capacity
+	 * \return the actual capacity
+	 */
+	static size_t round_capacity(size_t val)
+	{
+		size_t cap = 2;
+		while (cap < val) {
+			cap <<= 1;
+		}
+		return cap;
+	}
+
+public:
+	/** Create a new queue.
+	 * \param capacity: the minimum number of elements the queue can hold,
+	 * rounded up to the next power of two
+	 */
+	explicit BoundedQueue(size_t capacity)
+	: cells(new Cell[round_capacity(capacity)]),
+	  mask(round_capacity(capacity) - 1), enqueue_pos(0), dequeue_pos(0)
+	{
+		for (size_t i = 0; i <= mask; ++i) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	BoundedQueue(const BoundedQueue&) = delete;
+	BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+	/** Attempt to push an element without blocking.
+	 * \param val: the element to move into the queue
+	 * \return true if pushed, false if the queue was full (val is untouched)
+	 */
+	bool try_push(T&& val)
+	{
+		Cell* cell;
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+
+		while (true) {
+			cell = &cells[pos & mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(seq) -
+							static_cast<intptr_t>(pos);
+
+			// The slot is free; try to claim it.
+			if (diff == 0) {
+				if (enqueue_pos.compare_exchange_weak(
+						pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			// The slot still holds an unconsumed element: we're full.
+			else if (diff < 0) {
+				return false;
+			}
+			// Another producer beat us to it; reload and retry.
+			else {
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->data = std::move(val);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Attempt to pop an element without blocking.
+	 * \param val: receives the popped element
+	 * \return true if popped, false if the queue was empty
+	 */
+	bool try_pop(T& val)
+	{
+		Cell* cell;
+		size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+
+		while (true) {
+			cell = &cells[pos & mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(seq) -
+							static_cast<intptr_t>(pos + 1);
+
+			// The slot holds a published element; try to claim it.
+			if (diff == 0) {
+				if (dequeue_pos.compare_exchange_weak(
+						pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			// Nothing has been published here yet: we're empty.
+			else if (diff < 0) {
+				return false;
+			}
+			// Another consumer beat us to it; reload and retry.
+			else {
+				pos = dequeue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		val = std::move(cell->data);
+		cell->sequence.store(pos + mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Check whether the queue is (momentarily) empty.
+	 * This is only a hint while other threads are pushing or popping.
+	 * \return true if empty
+	 */
+	bool empty() const
+	{
+		return enqueue_pos.load(std::memory_order_acquire) ==
+			   dequeue_pos.load(std::memory_order_acquire);
+	}
+
+	/// \return the number of elements the queue can hold
+	size_t capacity() const { return mask + 1; }
+
+	~BoundedQueue() = default;
+};
+
+#endif
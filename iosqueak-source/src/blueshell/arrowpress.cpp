@@ -2,45 +2,37 @@
 
 size_t Blueshell::arrow_press(std::string& sent_command)
 {
+	// The escape character has already been read.
+	int keypress{27};
+
 	while (true) {
-		int keypress{Blueshell::getch()};
-
-		/* Sometimes this is required for operating
-		 * systems that send different code for
-		 * delete button
-		 */
-		if (keypress == 126) {
-			Blueshell::delete_char(sent_command);
-			return 0;
-		}
 		/* If arrow keys are not pressed, return
 		 * which key was. */
-		if (keypress != 27 && keypress != 91) {
-			/* If no previous command was selected
-			 * return keypress. */
-			if (prev_cmd_holder.empty())
-				return keypress;
-
+		if (keypress != 27) {
 			/* If a previous command was selected
 			 * send that back to caller and empty
 			 * prev_cmd_holder. */
-			if (prev_cmd_holder != sent_command) {
+			if (!prev_cmd_holder.empty()) {
 				sent_command = prev_cmd_holder;
 				prev_cmd_holder = std::string();
-
-				return keypress;
 			}
+			return keypress;
 		}
 
-		keypress = Blueshell::getch();
+		/* Parse the whole sequence from the input buffer, e.g.
+		 * "\x1b[A" for the up arrow, or "\x1b[3~" for delete. */
+		int param{0};
+		int sequence{terminal.read_escape(param)};
 
-		if (keypress == 91) {
+		// A lone escape; move on to the key after it.
+		if (sequence < 0) {
 			keypress = Blueshell::getch();
+			continue;
 		}
 
-		switch (keypress) {
+		switch (sequence) {
 			// If up arrow was pressed:
-			case 65: {
+			case 'A': {
 				(vec_size >= previous_commands.size())
 					? vec_size = previous_commands.size()
 					: ++vec_size;
@@ -54,11 +46,11 @@ size_t Blueshell::arrow_press(std::string& sent_command)
 
 					Blueshell::print_line(prev_cmd_holder);
 				}
-				continue;
+				break;
 			}
 
 			// If down arrow was pressed:
-			case 66: {
+			case 'B': {
 				cursor_moves = 0;
 				(vec_size <= 1) ? vec_size = 0 : --vec_size;
 
@@ -80,24 +72,22 @@ size_t Blueshell::arrow_press(std::string& sent_command)
 					prev_cmd_holder = previous_commands[vec_size - 1].second;
 					Blueshell::print_line(prev_cmd_holder);
 				}
-				continue;
+				break;
 			}
 
 			// Check for right arrow press.
-			case 67: {
+			case 'C': {
 				if (cursor_moves > 0) {
 					--cursor_moves;
 					Blueshell::print_line((!prev_cmd_holder.empty())
 											  ? prev_cmd_holder
 											  : sent_command);
 				}
-
-				continue;
+				break;
 			}
 
 			// Check for left arrow press.
-			case 68: {
-				//
+			case 'D': {
 				if (cursor_moves <
 					static_cast<int>((!prev_cmd_holder.empty())
 										 ? prev_cmd_holder.size()
@@ -107,22 +97,36 @@ size_t Blueshell::arrow_press(std::string& sent_command)
 											  ? prev_cmd_holder
 											  : sent_command);
 				}
-
-				continue;
+				break;
 			}
 
 			// Check for end key press.
-			case 70: {
+			case 'F': {
 				cursor_moves = 0;
 				return 0;
 			}
 
 			// Check for home key press
-			case 72: {
+			case 'H': {
 				cursor_moves = sent_command.size();
 				return 0;
 			}
+
+			/* Delete, home and end keys on terminals that send
+			 * "\x1b[<number>~" for them. */
+			case '~': {
+				if (param == 3) {
+					Blueshell::delete_char(sent_command);
+				} else if (param == 1 || param == 7) {
+					cursor_moves = sent_command.size();
+				} else if (param == 4 || param == 8) {
+					cursor_moves = 0;
+				}
+				return 0;
+			}
 		}
+
+		keypress = Blueshell::getch();
 	}
 
 	return 0;
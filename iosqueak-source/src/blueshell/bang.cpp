@@ -1,3 +1,5 @@
+#include <charconv>
+
 #include "../include/iosqueak/blueshell.hpp"
 
 int Blueshell::bang(std::string& sent_command)
@@ -34,19 +36,24 @@ int Blueshell::bang(std::string& sent_command)
 				// Remove the '!' from the front of command.
 				sent_command.erase(0, 1);
 
-				// Search for command matching the number entered.
-				auto cmd = std::find_if(previous_commands.begin(),
-										previous_commands.end(),
-										[&sent_command](const auto& cmd) {
-											return std::to_string(cmd.first) ==
-												   sent_command;
-										});
+				// Look up the command by the number entered.
+				size_t number{0};
+				auto parsed{std::from_chars(sent_command.data(),
+											sent_command.data() +
+												sent_command.size(),
+											number)};
+				std::optional<std::string_view> cmd;
+				if (parsed.ec == std::errc()) {
+					cmd = previous_commands.find(number);
+				}
 
 				// If found, send command, otherwise allow to enter another.
-				if (cmd != previous_commands.end()) {
-					sent_command = cmd->second;
+				if (cmd) {
+					sent_command = std::string(*cmd);
 					return 0;
 				} else {
+					line.flush();
+					line.invalidate();
 					channel << "\nNo command matching " << sent_command
 							<< IOCtrl::endl;
 					sent_command = "!";
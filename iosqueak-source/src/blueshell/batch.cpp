@@ -0,0 +1,121 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../include/iosqueak/blueshell.hpp"
+
+bool Blueshell::run_line(std::string_view line,
+						 batch_result& result,
+						 bool stop_on_error)
+{
+	// Trim whitespace (including the \r of \r\n line endings).
+	const char* whitespace{" \t\r\n\v\f"};
+	size_t start{line.find_first_not_of(whitespace)};
+	if (start == std::string_view::npos) {
+		return true;
+	}
+	line = line.substr(start, line.find_last_not_of(whitespace) - start + 1);
+
+	// Skip comments.
+	if (line.front() == '#') {
+		return true;
+	}
+
+	if (line == "quit" || line == "exit") {
+		return false;
+	}
+
+	std::string sent_command{line};
+	int status{Blueshell::process_command(sent_command, false)};
+
+	++result.commands;
+	if (status != 0) {
+		if (result.failures++ == 0) {
+			result.status = status;
+		}
+		return !stop_on_error;
+	}
+	return true;
+}
+
+Blueshell::batch_result Blueshell::run_string(std::string_view script,
+											  bool stop_on_error)
+{
+	Blueshell::registerdefaults();
+
+	batch_result result;
+	while (!script.empty()) {
+		size_t end{script.find('\n')};
+		if (!run_line(script.substr(0, end), result, stop_on_error) ||
+			end == std::string_view::npos) {
+			break;
+		}
+		script.remove_prefix(end + 1);
+	}
+	return result;
+}
+
+Blueshell::batch_result Blueshell::run_fd(int fd, bool stop_on_error)
+{
+	Blueshell::registerdefaults();
+
+	batch_result result;
+	// Holds the unfinished line at the end of what was read so far.
+	std::string pending;
+	char buffer[65536];
+
+	while (true) {
+		ssize_t got{read(fd, buffer, sizeof(buffer))};
+		if (got < 0 && errno == EINTR) {
+			continue;
+		}
+		if (got <= 0) {
+			break;
+		}
+
+		// Run every complete line straight from the buffer.
+		std::string_view chunk(buffer, static_cast<size_t>(got));
+		size_t end{chunk.find('\n')};
+		while (end != std::string_view::npos) {
+			bool keep_going;
+			if (pending.empty()) {
+				keep_going =
+					run_line(chunk.substr(0, end), result, stop_on_error);
+			} else {
+				pending.append(chunk.substr(0, end));
+				keep_going = run_line(pending, result, stop_on_error);
+				pending.clear();
+			}
+			if (!keep_going) {
+				return result;
+			}
+			chunk.remove_prefix(end + 1);
+			end = chunk.find('\n');
+		}
+		pending.append(chunk);
+	}
+
+	// The last line may not end with a newline.
+	if (!pending.empty()) {
+		run_line(pending, result, stop_on_error);
+	}
+	return result;
+}
+
+Blueshell::batch_result Blueshell::run_file(const std::string& path,
+											bool stop_on_error)
+{
+	int fd{open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+	if (fd < 0) {
+		channel << IOCat::error << "Cannot open " << path << IOCtrl::endl;
+		batch_result result;
+		// As shells do for a missing script.
+		result.failures = 1;
+		result.status = unknown_command;
+		return result;
+	}
+
+	batch_result result{run_fd(fd, stop_on_error)};
+	close(fd);
+	return result;
+}
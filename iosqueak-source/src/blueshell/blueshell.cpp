@@ -7,7 +7,9 @@ Blueshell::Blueshell(std::string sent_name) : shell_name(sent_name)
 
 Blueshell::~Blueshell()
 {
-	// dtor
+	// Background jobs may still be using the shell.
+	jobs.stop();
+	Blueshell::capture_output(false);
 }
 
 // A function that just clears the screen.
@@ -17,19 +19,15 @@ int Blueshell::clear_screen(arguments&)
 	return 0;
 }
 
-// Prints command to screen, by erasing the line first.
+/* Prints command to screen. Only the changes since the last time are
+ * sent, once the waiting input has been handled (see getch()). */
 void Blueshell::print_line(const std::string& sent_command)
 {
-	// Create a string to place cursor position.
-	std::string place_cursor{
-		"\x1b[" + std::to_string((sent_command.size() + 4) - cursor_moves) +
-		"C"};
-
-	/* Carriage return followed by clearing the line.
-	 * Then print >>> and the command. Set cursor position.*/
-	channel << IOCtrl::r << "\x1b[2K"
-			<< ">>> " << sent_command << IOCtrl::r << place_cursor
-			<< IOCtrl::end;
+	// cursor_moves counts back from the end of the command.
+	size_t moves{static_cast<size_t>(std::max(cursor_moves, 0))};
+	size_t position{(moves < sent_command.size()) ? sent_command.size() - moves
+												  : 0};
+	line.render(sent_command, position);
 }
 
 // Lists all of the registered commands.
@@ -38,8 +36,8 @@ int Blueshell::list_commands(arguments&)
 	channel << IOFormatTextFG::green << IOCtrl::n
 			<< "These are the commands currently available:"
 			<< IOFormatTextFG::white << IOCtrl::n;
-	for (auto& cmd : stored_commands.get_set()) {
-		channel << cmd.func_name << '\t';
+	for (auto& [name, cmd] : stored_commands.get_map()) {
+		channel << name << '\t';
 	}
 	channel << IOCtrl::endl;
 
@@ -0,0 +1,283 @@
+#include "iosqueak/cmd_args.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+namespace
+{
+/* Parse a whole word as a finite decimal number, such as -2.5, .5 or 1e3,
+ * the same way in every locale. Hexadecimal, infinity, NaN, a leading '+'
+ * and surrounding whitespace aren't accepted.
+ * \return true if the whole word was a number in range, else false */
+bool _parse_real(std::string_view word, double& real)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	auto result{std::from_chars(word.data(), word.data() + word.size(), real)};
+	return result.ec == std::errc() &&
+		   result.ptr == word.data() + word.size() && std::isfinite(real);
+#else
+	/* Without std::from_chars() for doubles, check the form by hand, so
+	 * strtod() can't accept anything more. It still uses the locale's
+	 * decimal point, so "2.5" may be rejected, but nothing else is read. */
+	size_t i{(!word.empty() && word[0] == '-') ? size_t{1} : size_t{0}};
+	size_t digits{0};
+	for (bool point{false}; i < word.size(); ++i) {
+		if (word[i] >= '0' && word[i] <= '9') {
+			++digits;
+		} else if (word[i] == '.' && !point) {
+			point = true;
+		} else {
+			break;
+		}
+	}
+	if (digits == 0) {
+		return false;
+	}
+	if (i < word.size() && (word[i] == 'e' || word[i] == 'E')) {
+		++i;
+		if (i < word.size() && (word[i] == '-' || word[i] == '+')) {
+			++i;
+		}
+		size_t exponent{i};
+		while (i < word.size() && word[i] >= '0' && word[i] <= '9') {
+			++i;
+		}
+		if (i == exponent) {
+			return false;
+		}
+	}
+	if (i != word.size()) {
+		return false;
+	}
+
+	// strtod() needs the word to be null-terminated.
+	std::string copy(word);
+	char* end{nullptr};
+	real = std::strtod(copy.c_str(), &end);
+	return end == copy.c_str() + copy.size() && std::isfinite(real);
+#endif
+}
+}  // namespace
+
+bool Cmd_args::flag(std::string_view name) const
+{
+	if (schema == nullptr) {
+		return false;
+	}
+	for (size_t i{0}; i < schema->flag_names.size(); ++i) {
+		if (schema->flag_names[i] == name) {
+			return (flags >> i) & 1;
+		}
+	}
+	return false;
+}
+
+Cmd_schema& Cmd_schema::add(std::string name,
+							Cmd_arg_type type,
+							std::vector<std::string> choices)
+{
+	positional.push_back(arg{std::move(name), type, std::move(choices)});
+	return *this;
+}
+
+Cmd_schema& Cmd_schema::integer(std::string name)
+{
+	return add(std::move(name), Cmd_arg_type::integer);
+}
+
+Cmd_schema& Cmd_schema::real(std::string name)
+{
+	return add(std::move(name), Cmd_arg_type::real);
+}
+
+Cmd_schema& Cmd_schema::boolean(std::string name)
+{
+	return add(std::move(name), Cmd_arg_type::boolean);
+}
+
+Cmd_schema& Cmd_schema::choice(std::string name,
+							   std::vector<std::string> choices)
+{
+	return add(std::move(name), Cmd_arg_type::choice, std::move(choices));
+}
+
+Cmd_schema& Cmd_schema::text(std::string name)
+{
+	return add(std::move(name), Cmd_arg_type::text);
+}
+
+Cmd_schema& Cmd_schema::flag(std::string name)
+{
+	assert(flag_names.size() < max_flags);
+	flag_names.push_back(std::move(name));
+	return *this;
+}
+
+Cmd_schema& Cmd_schema::variadic(std::string name)
+{
+	rest_name = std::move(name);
+	has_rest = true;
+	return *this;
+}
+
+std::string Cmd_schema::usage() const
+{
+	std::string result;
+	for (const arg& each : positional) {
+		result += '<';
+		result += each.name;
+		result += ':';
+		switch (each.type) {
+			case Cmd_arg_type::integer:
+				result += "int";
+				break;
+			case Cmd_arg_type::real:
+				result += "number";
+				break;
+			case Cmd_arg_type::boolean:
+				result += "bool";
+				break;
+			case Cmd_arg_type::choice:
+				for (size_t i{0}; i < each.choices.size(); ++i) {
+					if (i > 0) {
+						result += '|';
+					}
+					result += each.choices[i];
+				}
+				break;
+			case Cmd_arg_type::text:
+				result += "text";
+				break;
+		}
+		result += "> ";
+	}
+	for (const std::string& name : flag_names) {
+		result += "[--" + name + "] ";
+	}
+	if (has_rest) {
+		result += '[' + rest_name + "...] ";
+	}
+	if (!result.empty()) {
+		result.pop_back();
+	}
+	return result;
+}
+
+bool Cmd_schema::parse_value(const arg& each,
+							 std::string_view word,
+							 Cmd_args& args,
+							 std::string& error) const
+{
+	Cmd_args::value parsed;
+	parsed.type = each.type;
+	bool valid{false};
+
+	switch (each.type) {
+		case Cmd_arg_type::integer: {
+			auto result{std::from_chars(word.data(),
+										word.data() + word.size(),
+										parsed.integer)};
+			valid = result.ec == std::errc() &&
+					result.ptr == word.data() + word.size();
+			break;
+		}
+		case Cmd_arg_type::real: {
+			valid = _parse_real(word, parsed.real);
+			break;
+		}
+		case Cmd_arg_type::boolean: {
+			if (word == "true" || word == "yes" || word == "on" ||
+				word == "1") {
+				parsed.boolean = valid = true;
+			} else if (word == "false" || word == "no" || word == "off" ||
+					   word == "0") {
+				parsed.boolean = false;
+				valid = true;
+			}
+			break;
+		}
+		case Cmd_arg_type::choice: {
+			for (size_t i{0}; i < each.choices.size(); ++i) {
+				if (each.choices[i] == word) {
+					parsed.index = i;
+					valid = true;
+					break;
+				}
+			}
+			break;
+		}
+		case Cmd_arg_type::text: {
+			parsed.index = args.texts.size();
+			args.texts.emplace_back(word);
+			valid = true;
+			break;
+		}
+	}
+
+	if (!valid) {
+		error = "Invalid " + each.name + ": '" + std::string(word) + "'";
+		return false;
+	}
+	args.values.push_back(parsed);
+	return true;
+}
+
+bool Cmd_schema::parse(const std::string_view* words,
+					   size_t count,
+					   Cmd_args& args,
+					   std::string& error) const
+{
+	args.schema = this;
+	args.values.clear();
+	args.values.reserve(positional.size());
+	args.texts.clear();
+	args.rest_words.clear();
+	args.flags = 0;
+
+	bool flags_done{false};
+	for (size_t i{0}; i < count; ++i) {
+		std::string_view word{words[i]};
+
+		// Flags can be anywhere, up to a "--".
+		if (!flags_done && word.size() >= 2 && word[0] == '-' &&
+			word[1] == '-') {
+			if (word.size() == 2) {
+				flags_done = true;
+				continue;
+			}
+			std::string_view name{word.substr(2)};
+			size_t found{0};
+			while (found < flag_names.size() && flag_names[found] != name) {
+				++found;
+			}
+			if (found == flag_names.size()) {
+				error = "Unknown flag '" + std::string(word) + "'";
+				return false;
+			}
+			args.flags |= uint64_t{1} << found;
+			continue;
+		}
+
+		if (args.values.size() < positional.size()) {
+			if (!parse_value(positional[args.values.size()],
+							 word,
+							 args,
+							 error)) {
+				return false;
+			}
+		} else if (has_rest) {
+			args.rest_words.emplace_back(word);
+		} else {
+			error = "Too many arguments";
+			return false;
+		}
+	}
+
+	if (args.values.size() < positional.size()) {
+		error = "Missing " + positional[args.values.size()].name;
+		return false;
+	}
+	return true;
+}
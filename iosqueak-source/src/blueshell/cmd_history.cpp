@@ -0,0 +1,455 @@
+#include "iosqueak/cmd_history.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+/* Find a first word in the index without building a std::string for it,
+ * where the standard library allows. */
+template<typename Map>
+auto _find_word(Map& words, std::string_view word) -> decltype(words.begin())
+{
+#if defined(__cpp_lib_generic_unordered_lookup)
+	return words.find(word);
+#else
+	// Reuse one key, so lookups stop allocating once it is large enough.
+	thread_local std::string key;
+	key.assign(word);
+	return words.find(key);
+#endif
+}
+}  // namespace
+
+Cmd_history::Cmd_history(size_t capacity)
+: ring((capacity > 0) ? capacity : 1), masks(ring.size(), 0)
+{
+}
+
+uint64_t Cmd_history::char_mask(std::string_view text)
+{
+	uint64_t result{0};
+	for (char ch : text) {
+		unsigned char c{static_cast<unsigned char>(ch)};
+		if (c >= 'A' && c <= 'Z') {
+			c = static_cast<unsigned char>(c - 'A' + 'a');
+		}
+		// Letters and digits get a bit each; everything else shares the rest.
+		unsigned int bit;
+		if (c >= 'a' && c <= 'z') {
+			bit = c - 'a';
+		} else if (c >= '0' && c <= '9') {
+			bit = 26 + (c - '0');
+		} else {
+			bit = 36 + (c % 28);
+		}
+		result |= uint64_t{1} << bit;
+	}
+	return result;
+}
+
+int Cmd_history::fuzzy_score(std::string_view query, std::string_view text)
+{
+	auto lower{[](char ch) {
+		return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a')
+										: ch;
+	}};
+
+	int score{0};
+	size_t at{0};
+	size_t previous{std::string_view::npos};
+
+	for (char ch : query) {
+		ch = lower(ch);
+		while (at < text.size() && lower(text[at]) != ch) {
+			++at;
+		}
+		if (at == text.size()) {
+			return -1;
+		}
+
+		score += 1;
+		if (previous != std::string_view::npos && at == previous + 1) {
+			score += 5;
+		} else if (previous != std::string_view::npos) {
+			score -= static_cast<int>(std::min<size_t>(at - previous - 1, 3));
+		}
+		if (at == 0) {
+			score += 10;
+		} else if (text[at - 1] == ' ' || text[at - 1] == '-' ||
+				   text[at - 1] == '_' || text[at - 1] == '/') {
+			score += 3;
+		}
+
+		previous = at++;
+	}
+	return score;
+}
+
+size_t Cmd_history::parse_line(std::string_view line,
+								std::string_view& command,
+								bool& escaped)
+{
+	size_t number{0};
+	size_t i{0};
+	while (i < line.size() && line[i] >= '0' && line[i] <= '9') {
+		number = number * 10 + static_cast<size_t>(line[i] - '0');
+		++i;
+	}
+	if (i == 0 || i == line.size() || (line[i] != ' ' && line[i] != '\t')) {
+		return 0;
+	}
+	escaped = (line[i] == '\t');
+	command = line.substr(i + 1);
+	return number;
+}
+
+void Cmd_history::format_line(std::string& line,
+							  size_t number,
+							  std::string_view command)
+{
+	line.assign(std::to_string(number));
+	if (command.find('\n') == std::string_view::npos) {
+		line.push_back(' ');
+		line.append(command);
+	} else {
+		line.push_back('\t');
+		for (char ch : command) {
+			if (ch == '\n') {
+				line.append("\\n");
+			} else if (ch == '\\') {
+				line.append("\\\\");
+			} else {
+				line.push_back(ch);
+			}
+		}
+	}
+	line.push_back('\n');
+}
+
+void Cmd_history::unescape(std::string& command, std::string_view escaped)
+{
+	command.clear();
+	for (size_t i{0}; i < escaped.size(); ++i) {
+		if (escaped[i] == '\\' && i + 1 < escaped.size()) {
+			if (escaped[i + 1] == 'n') {
+				command.push_back('\n');
+				++i;
+				continue;
+			}
+			if (escaped[i + 1] == '\\') {
+				command.push_back('\\');
+				++i;
+				continue;
+			}
+		}
+		command.push_back(escaped[i]);
+	}
+}
+
+void Cmd_history::unmap_file() const
+{
+	if (mapped != nullptr) {
+		munmap(const_cast<char*>(mapped), mapped_size);
+		mapped = nullptr;
+		mapped_size = 0;
+	}
+	for (const auto& [data, size] : retired) {
+		munmap(const_cast<char*>(data), size);
+	}
+	retired.clear();
+	decoded.clear();
+}
+
+void Cmd_history::map_file() const
+{
+	if (mapped != nullptr) {
+		retired.emplace_back(mapped, mapped_size);
+		mapped = nullptr;
+		mapped_size = 0;
+	}
+
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0 || info.st_size <= 0) {
+		return;
+	}
+
+	void* data{mmap(nullptr,
+					static_cast<size_t>(info.st_size),
+					PROT_READ,
+					MAP_SHARED,
+					fd,
+					0)};
+	if (data != MAP_FAILED) {
+		mapped = static_cast<const char*>(data);
+		mapped_size = static_cast<size_t>(info.st_size);
+	}
+}
+
+void Cmd_history::remember(size_t number, std::string_view command)
+{
+	entry& slot{ring[(number - 1) % ring.size()]};
+
+	/* Forget the oldest command. Since numbers are consecutive, it is
+	 * first in its index, but don't count on it. */
+	if (count == ring.size()) {
+		auto found{_find_word(first_words, words.first(slot.second))};
+		if (found != first_words.end()) {
+			std::deque<size_t>& numbers{found->second};
+			auto old{std::find(numbers.begin(), numbers.end(), slot.first)};
+			if (old != numbers.end()) {
+				numbers.erase(old);
+			}
+			if (numbers.empty()) {
+				first_words.erase(found);
+			}
+		}
+	} else {
+		++count;
+	}
+
+	slot.first = number;
+	slot.second.assign(command);
+	masks[(number - 1) % ring.size()] = char_mask(command);
+	std::string_view word{words.first(command)};
+	auto found{_find_word(first_words, word)};
+	if (found == first_words.end()) {
+		found = first_words.emplace(std::string(word), std::deque<size_t>())
+					.first;
+	}
+	found->second.push_back(number);
+	last = number;
+}
+
+void Cmd_history::forget()
+{
+	count = 0;
+	last = 0;
+	first_words.clear();
+}
+
+bool Cmd_history::open(const std::string& path)
+{
+	close();
+
+	do {
+		fd = ::open(path.c_str(),
+					O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+					0600);
+	} while (fd < 0 && errno == EINTR);
+	if (fd < 0) {
+		return false;
+	}
+
+	forget();
+
+	map_file();
+	run_start = mapped_size;
+	run_first = 0;
+	run_complete = true;
+	if (mapped == nullptr) {
+		return true;
+	}
+
+	// Walk back from the end to the start of the most recent lines.
+	std::string_view log(mapped, mapped_size);
+	size_t start{log.size()};
+	size_t cursor{(log.back() == '\n') ? log.size() - 1 : log.size()};
+	bool whole_file{false};
+	for (size_t lines{0}; lines < ring.size(); ++lines) {
+		size_t newline{(cursor == 0) ? std::string_view::npos
+									 : log.rfind('\n', cursor - 1)};
+		if (newline == std::string_view::npos) {
+			start = 0;
+			whole_file = true;
+			break;
+		}
+		start = newline + 1;
+		cursor = newline;
+	}
+
+	/* Then read them forward. Only the end of the file is ever touched.
+	 * The ring needs consecutive numbers, so a gap, repeat or step back in
+	 * the numbering (e.g. from a hand-edited log) starts it over; only the
+	 * last consecutive run is remembered. */
+	size_t previous{0};
+	bool broken{false};
+	std::string unescaped;
+	while (start < log.size()) {
+		size_t end{log.find('\n', start)};
+		if (end == std::string_view::npos) {
+			end = log.size();
+		}
+		std::string_view command;
+		bool escaped{false};
+		size_t number{
+			parse_line(log.substr(start, end - start), command, escaped)};
+		if (number != 0) {
+			if (last != 0 && number != last + 1) {
+				forget();
+			}
+			// A repeat or step back also starts a new run to search.
+			if (previous == 0 || number <= previous) {
+				broken = (previous != 0);
+				run_start = start;
+				run_first = number;
+			}
+			previous = number;
+			if (escaped) {
+				unescape(unescaped, command);
+				command = unescaped;
+			}
+			remember(number, command);
+		}
+		start = end + 1;
+	}
+
+	/* Unless the run is known to start here, it may go back further than
+	 * was read; that is only looked for if a search needs it. */
+	run_complete = (last == 0 || broken || whole_file);
+	return true;
+}
+
+void Cmd_history::find_run_start() const
+{
+	std::string_view log(mapped, mapped_size);
+	size_t cursor{(run_start < log.size()) ? run_start : log.size()};
+	while (cursor > 0) {
+		// The previous line ends with the newline just before the cursor.
+		size_t end{cursor - 1};
+		size_t start{(end == 0) ? std::string_view::npos
+								: log.rfind('\n', end - 1)};
+		start = (start == std::string_view::npos) ? 0 : start + 1;
+
+		std::string_view command;
+		bool escaped{false};
+		size_t number{
+			parse_line(log.substr(start, end - start), command, escaped)};
+		if (number != 0) {
+			if (number >= run_first) {
+				break;
+			}
+			run_start = start;
+			run_first = number;
+		}
+		cursor = start;
+	}
+	run_complete = true;
+}
+
+void Cmd_history::close()
+{
+	unmap_file();
+	if (fd >= 0) {
+		::close(fd);
+		fd = -1;
+	}
+}
+
+size_t Cmd_history::add(std::string_view command)
+{
+	size_t number{last + 1};
+	remember(number, command);
+
+	if (fd >= 0) {
+		std::string line;
+		format_line(line, number, command);
+
+		const char* data{line.data()};
+		size_t left{line.size()};
+		while (left > 0) {
+			ssize_t written{write(fd, data, left)};
+			if (written < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				// Keep going without the log.
+				close();
+				break;
+			}
+			data += written;
+			left -= static_cast<size_t>(written);
+		}
+	}
+	return number;
+}
+
+std::optional<std::string_view> Cmd_history::search_file(size_t number) const
+{
+	if (!run_complete) {
+		find_run_start();
+	}
+
+	std::string_view log(mapped, mapped_size);
+	size_t low{run_start};
+	size_t high{log.size()};
+
+	/* Lines in the run are in order of their numbers, so search by byte
+	 * offset. Earlier runs may reuse the same numbers, so stay out of them. */
+	while (low < high) {
+		size_t middle{low + (high - low) / 2};
+		size_t start{(middle == 0) ? std::string_view::npos
+								   : log.rfind('\n', middle - 1)};
+		start = (start == std::string_view::npos || start < low) ? low
+																 : start + 1;
+		size_t end{log.find('\n', start)};
+		if (end == std::string_view::npos) {
+			end = log.size();
+		}
+
+		std::string_view command;
+		bool escaped{false};
+		size_t found{
+			parse_line(log.substr(start, end - start), command, escaped)};
+		if (found == number) {
+			if (!escaped) {
+				return command;
+			}
+			auto [decoded_command, added]{decoded.try_emplace(number)};
+			if (added) {
+				unescape(decoded_command->second, command);
+			}
+			return std::string_view(decoded_command->second);
+		}
+		if (found < number) {
+			low = end + 1;
+		} else {
+			high = start;
+		}
+	}
+	return std::nullopt;
+}
+
+std::optional<std::string_view> Cmd_history::find(size_t number) const
+{
+	if (number == 0 || number > last) {
+		return std::nullopt;
+	}
+	if (number >= oldest()) {
+		const entry& slot{ring[(number - 1) % ring.size()]};
+		if (slot.first == number) {
+			return std::string_view(slot.second);
+		}
+	}
+
+	if (mapped == nullptr && fd < 0) {
+		return std::nullopt;
+	}
+	// The mapping may predate the command; if so, map the file again.
+	std::optional<std::string_view> found{search_file(number)};
+	if (!found && fd >= 0) {
+		map_file();
+		found = search_file(number);
+	}
+	return found;
+}
+
+const std::deque<size_t>* Cmd_history::starting_with(std::string_view word) const
+{
+	auto found{_find_word(first_words, word)};
+	return (found != first_words.end()) ? &found->second : nullptr;
+}
@@ -0,0 +1,194 @@
+#include "iosqueak/cmd_jobs.hpp"
+
+#include <algorithm>
+#include <utility>
+
+thread_local Cmd_jobs::record* Cmd_jobs::current = nullptr;
+
+Cmd_jobs::Cmd_jobs(size_t thread_count) : threads(thread_count)
+{
+	/* Jobs are mostly commands that wait on something, rather than
+	 * computing, so run a few even with fewer hardware threads. */
+	if (threads == 0) {
+		threads = std::max(std::thread::hardware_concurrency(), 4u);
+	}
+}
+
+void Cmd_jobs::on_finish(std::function<void(const job&)> callback)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	finished = std::move(callback);
+}
+
+bool Cmd_jobs::is_finished(const record& rec)
+{
+	return rec.info.state == job_state::done ||
+		   rec.info.state == job_state::cancelled;
+}
+
+size_t Cmd_jobs::start(std::string command, std::function<int()> work)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto rec{std::make_shared<record>()};
+	rec->info = job{next_id++, std::move(command), job_state::queued, 0};
+	rec->work = std::move(work);
+	table.emplace(rec->info.id, rec);
+	pending.push_back(rec);
+
+	// Only start another thread if the ones there are all busy.
+	if (workers.size() < threads) {
+		size_t busy{0};
+		for (auto& [id, each] : table) {
+			if (each->info.state == job_state::running) {
+				++busy;
+			}
+		}
+		if (busy + pending.size() > workers.size()) {
+			stopping = false;
+			workers.emplace_back(&Cmd_jobs::worker_loop, this);
+		}
+	}
+
+	work_ready.notify_one();
+	return rec->info.id;
+}
+
+void Cmd_jobs::worker_loop()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true) {
+		work_ready.wait(guard, [this] { return stopping || !pending.empty(); });
+		if (stopping && pending.empty()) {
+			return;
+		}
+
+		std::shared_ptr<record> rec{std::move(pending.front())};
+		pending.pop_front();
+		rec->info.state = job_state::running;
+
+		// Run the command without holding up the rest of the shell.
+		guard.unlock();
+		current = rec.get();
+		int status{threw};
+		try {
+			status = rec->work();
+		} catch (...) {
+			// The job failed, but the worker carries on.
+		}
+		current = nullptr;
+		rec->work = nullptr;
+		guard.lock();
+
+		rec->info.status = status;
+		rec->info.state =
+			rec->cancel ? job_state::cancelled : job_state::done;
+		job info{rec->info};
+		auto callback{finished};
+
+		// Report the job before anything waiting on it carries on.
+		if (callback) {
+			guard.unlock();
+			callback(info);
+			guard.lock();
+		}
+		work_done.notify_all();
+	}
+}
+
+std::vector<Cmd_jobs::job> Cmd_jobs::list() const
+{
+	std::lock_guard<std::mutex> guard(lock);
+	std::vector<job> jobs;
+	jobs.reserve(table.size());
+	for (auto& [id, rec] : table) {
+		jobs.push_back(rec->info);
+	}
+	return jobs;
+}
+
+void Cmd_jobs::forget_finished()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	for (auto it{table.begin()}; it != table.end();) {
+		if (is_finished(*it->second)) {
+			it = table.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+std::optional<Cmd_jobs::job> Cmd_jobs::wait(size_t id)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	auto found{table.find(id)};
+	if (found == table.end()) {
+		return std::nullopt;
+	}
+
+	// Waiting for itself, a job would never finish.
+	std::shared_ptr<record> rec{found->second};
+	if (rec.get() == current) {
+		return std::nullopt;
+	}
+	work_done.wait(guard, [&rec] { return is_finished(*rec); });
+	table.erase(id);
+	return rec->info;
+}
+
+bool Cmd_jobs::cancel(size_t id)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	auto found{table.find(id)};
+	if (found == table.end() || is_finished(*found->second)) {
+		return false;
+	}
+
+	record& rec{*found->second};
+	rec.cancel = true;
+	if (rec.info.state == job_state::queued) {
+		// It never starts.
+		for (auto it{pending.begin()}; it != pending.end(); ++it) {
+			if (it->get() == &rec) {
+				pending.erase(it);
+				break;
+			}
+		}
+		rec.info.state = job_state::cancelled;
+		rec.work = nullptr;
+		work_done.notify_all();
+	}
+	return true;
+}
+
+bool Cmd_jobs::cancel_requested()
+{
+	return current != nullptr && current->cancel;
+}
+
+void Cmd_jobs::stop()
+{
+	std::vector<std::thread> joining;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		for (auto& rec : pending) {
+			rec->info.state = job_state::cancelled;
+			rec->work = nullptr;
+		}
+		pending.clear();
+		for (auto& [id, rec] : table) {
+			rec->cancel = true;
+		}
+		stopping = true;
+		joining.swap(workers);
+	}
+	work_ready.notify_all();
+	work_done.notify_all();
+
+	for (std::thread& worker : joining) {
+		worker.join();
+	}
+}
+
+Cmd_jobs::~Cmd_jobs() { stop(); }
@@ -1,24 +1,16 @@
 #include "iosqueak/cmd_map.hpp"
 
-bool Cmd_map::find_match(const std::string& sent_command)
+bool Cmd_map::find_match(std::string_view sent_command) const
 {
-	return std::any_of(commands.begin(),
-					   commands.end(),
-					   [&sent_command](const auto& cmd) {
-						   return cmd.func_name == sent_command;
-					   });
+	return commands.find(sent_command) != commands.end();
 }
 
 /* Check if number of arguments sent match the
  * number of arguments required. */
-bool Cmd_map::match_args(const std::string& cmd_name, size_t sent_args)
+bool Cmd_map::match_args(std::string_view cmd_name, size_t sent_args) const
 {
-	auto check{std::find_if(commands.begin(),
-							commands.end(),
-							[&cmd_name](const auto& cmd) {
-								return cmd.func_name == cmd_name;
-							})};
-	if (check != commands.end()) {
+	const func_info* check{find(cmd_name)};
+	if (check != nullptr) {
 		return check->number_of_args == sent_args;
 	}
 	return false;
@@ -30,24 +22,61 @@ void Cmd_map::add_command(const std::string& sent_name,
 						  const std::string& long_desc,
 						  size_t number_of_args)
 {
-	commands.insert({func_info{sent_name,
-							   sent_command,
-							   short_desc,
-							   long_desc,
-							   number_of_args}});
+	// Don't replace an existing command (or the name its key views).
+	if (find_match(sent_name)) {
+		return;
+	}
+
+	auto info{std::make_unique<func_info>(func_info{sent_name,
+													sent_command,
+													short_desc,
+													long_desc,
+													number_of_args,
+													{},
+													{}})};
+	std::string_view key{info->func_name};
+	commands.emplace(key, std::move(info));
+	names.insert(key);
 }
 
-details::func_info Cmd_map::send_element(const std::string& command)
+void Cmd_map::add_command(const std::string& sent_name,
+						  _typed_register& sent_command,
+						  Cmd_schema schema,
+						  const std::string& short_desc,
+						  const std::string& long_desc)
 {
-	auto name_check{
-		std::find_if(commands.begin(), commands.end(), [&command](auto& cmd) {
-			return cmd.func_name == command;
-		})};
-	func_info send;
+	if (find_match(sent_name)) {
+		return;
+	}
+
+	auto info{std::make_unique<func_info>()};
+	info->func_name = sent_name;
+	info->short_desc = short_desc;
+	info->long_desc = long_desc;
+	info->number_of_args = schema.size();
+	info->typed_command = sent_command;
+	info->schema = std::move(schema);
+	std::string_view key{info->func_name};
+	commands.emplace(key, std::move(info));
+	names.insert(key);
+}
+
+const details::func_info* Cmd_map::find(std::string_view command) const
+{
+	auto name_check{commands.find(command)};
 	if (name_check != commands.end()) {
-		send = *name_check;
+		return name_check->second.get();
 	}
-	return send;
+	return nullptr;
+}
+
+const details::func_info& Cmd_map::send_element(std::string_view command) const
+{
+	// Returned when there is no match; its name is "noname".
+	static const func_info none;
+
+	const func_info* send{find(command)};
+	return (send != nullptr) ? *send : none;
 }
 
 /* Function to send all short descriptions of the
@@ -55,11 +84,13 @@ details::func_info Cmd_map::send_element(const std::string& command)
 std::vector<std::pair<std::string, std::string>> Cmd_map::short_help()
 {
 	std::vector<std::pair<std::string, std::string>> vec;
+	vec.reserve(commands.size());
 	std::transform(this->commands.begin(),
 				   this->commands.end(),
 				   std::back_inserter(vec),
 				   [](auto& cmd) {
-					   return std::pair{cmd.func_name, cmd.short_desc};
+					   return std::pair{cmd.second->func_name,
+										cmd.second->short_desc};
 				   });
 
 	return vec;
@@ -70,11 +101,13 @@ std::vector<std::pair<std::string, std::string>> Cmd_map::short_help()
 std::vector<std::pair<std::string, std::string>> Cmd_map::long_help()
 {
 	std::vector<std::pair<std::string, std::string>> vec;
+	vec.reserve(commands.size());
 	std::transform(this->commands.begin(),
 				   this->commands.end(),
 				   std::back_inserter(vec),
 				   [](auto& cmd) {
-					   return std::pair{cmd.func_name, cmd.long_desc};
+					   return std::pair{cmd.second->func_name,
+										cmd.second->long_desc};
 				   });
 
 	return vec;
@@ -0,0 +1,87 @@
+#include "iosqueak/cmd_search.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+Cmd_search::Cmd_search(const Cmd_history& history) : history(history), levels(1)
+{
+	levels[0].reserve(history.size());
+	for (size_t i{0}; i < history.size(); ++i) {
+		levels[0].emplace_back(0, history[i].first);
+	}
+}
+
+void Cmd_search::restart()
+{
+	sorted = 0;
+	shown = 0;
+	seen.clear();
+	matched = !text.empty() && next_match();
+}
+
+bool Cmd_search::next_match()
+{
+	std::vector<scored>& ranked{levels.back()};
+	auto better{[](const scored& a, const scored& b) {
+		return (a.first != b.first) ? a.first > b.first : a.second > b.second;
+	}};
+	while (shown < ranked.size()) {
+		if (shown == sorted) {
+			size_t upto{std::min(ranked.size(), sorted * 2 + 32)};
+			std::partial_sort(ranked.begin() + sorted,
+							  ranked.begin() + upto,
+							  ranked.end(),
+							  better);
+			sorted = upto;
+		}
+		std::string_view command{*history.find(ranked[shown].second)};
+		if (seen.insert(command).second) {
+			current = command;
+			return true;
+		}
+		++shown;
+	}
+	return false;
+}
+
+void Cmd_search::push(char ch)
+{
+	// Only the current matches need checking.
+	text.push_back(ch);
+	uint64_t needed{Cmd_history::char_mask(text)};
+	std::vector<scored> narrowed;
+	for (const scored& match : levels.back()) {
+		if ((history.mask(match.second) & needed) != needed) {
+			continue;
+		}
+		int score{Cmd_history::fuzzy_score(text, *history.find(match.second))};
+		if (score >= 0) {
+			narrowed.emplace_back(score, match.second);
+		}
+	}
+	levels.push_back(std::move(narrowed));
+	restart();
+}
+
+void Cmd_search::pop()
+{
+	if (!text.empty()) {
+		text.pop_back();
+		levels.pop_back();
+		restart();
+	}
+}
+
+bool Cmd_search::next()
+{
+	if (!matched) {
+		return false;
+	}
+	size_t previous{shown++};
+	if (!next_match()) {
+		// There are no more, so stay on the last one.
+		shown = previous;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,100 @@
+#include "iosqueak/cmd_tokenizer.hpp"
+
+namespace
+{
+bool is_space(char ch)
+{
+	return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' ||
+		   ch == '\r';
+}
+
+bool is_quote(char ch) { return ch == '"' || ch == '\''; }
+}  // namespace
+
+void Cmd_tokenizer::scan(std::string_view line, size_t limit)
+{
+	words.clear();
+	storage.clear();
+
+	const size_t length{line.size()};
+	size_t i{0};
+	while (words.size() < limit) {
+		while (i < length && is_space(line[i])) {
+			++i;
+		}
+		if (i == length) {
+			break;
+		}
+
+		// A plain word is a view of the line.
+		size_t start{i};
+		while (i < length && !is_space(line[i]) && !is_quote(line[i])) {
+			++i;
+		}
+		if (i == length || is_space(line[i])) {
+			words.push_back(line.substr(start, i - start));
+			continue;
+		}
+
+		/* So is a quoted word without escapes. Otherwise, what was read
+		 * before the escape is copied, and the rest is handled below. */
+		char quote{'\0'};
+		size_t copied{i};
+		if (i == start) {
+			quote = line[i];
+			size_t end{i + 1};
+			while (end < length && line[end] != quote && line[end] != '\\') {
+				++end;
+			}
+			if (end < length && line[end] == quote &&
+				(end + 1 == length || is_space(line[end + 1]))) {
+				words.push_back(line.substr(i + 1, end - i - 1));
+				i = end + 1;
+				continue;
+			}
+			++start;
+			copied = i = end;
+		}
+
+		/* The unquoted words are never longer than the line, so reserving
+		 * that much up front keeps the earlier words from moving. */
+		if (storage.capacity() < length) {
+			storage.reserve(length);
+		}
+		size_t offset{storage.size()};
+		storage.append(line, start, copied - start);
+
+		for (; i < length; ++i) {
+			char ch{line[i]};
+			if (quote != '\0') {
+				if (ch == quote) {
+					quote = '\0';
+				} else if (ch == '\\' && i + 1 < length &&
+						   (is_quote(line[i + 1]) || line[i + 1] == '\\')) {
+					storage.push_back(line[++i]);
+				} else {
+					storage.push_back(ch);
+				}
+			} else if (is_space(ch)) {
+				break;
+			} else if (is_quote(ch)) {
+				quote = ch;
+			} else {
+				storage.push_back(ch);
+			}
+		}
+		words.push_back(std::string_view(storage).substr(offset));
+	}
+}
+
+const Cmd_tokenizer::tokens& Cmd_tokenizer::split(std::string_view line)
+{
+	scan(line, words.max_size());
+	return words;
+}
+
+std::string_view Cmd_tokenizer::first(std::string_view line)
+{
+	scan(line, 1);
+	return words.empty() ? std::string_view() : words.front();
+}
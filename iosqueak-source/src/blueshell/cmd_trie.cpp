@@ -0,0 +1,146 @@
+#include "iosqueak/cmd_trie.hpp"
+
+#include <algorithm>
+
+// Returns how many leading characters the two strings share.
+static size_t shared_length(std::string_view first, std::string_view second)
+{
+	size_t len{std::min(first.size(), second.size())};
+	size_t i{0};
+	while (i < len && first[i] == second[i]) {
+		++i;
+	}
+	return i;
+}
+
+std::vector<std::unique_ptr<Cmd_trie::node>>::iterator
+Cmd_trie::find_child(node& parent, char ch)
+{
+	return std::lower_bound(
+		parent.children.begin(),
+		parent.children.end(),
+		ch,
+		[](const auto& child, char c) { return child->label[0] < c; });
+}
+
+std::vector<std::unique_ptr<Cmd_trie::node>>::const_iterator
+Cmd_trie::find_child(const node& parent, char ch)
+{
+	return std::lower_bound(
+		parent.children.begin(),
+		parent.children.end(),
+		ch,
+		[](const auto& child, char c) { return child->label[0] < c; });
+}
+
+void Cmd_trie::insert(std::string_view name)
+{
+	node* current{&root};
+
+	while (!name.empty()) {
+		auto it{find_child(*current, name[0])};
+
+		// No edge starts with this character, so add the rest as a leaf.
+		if (it == current->children.end() || (*it)->label[0] != name[0]) {
+			auto leaf{std::make_unique<node>()};
+			leaf->label = std::string(name);
+			leaf->terminal = true;
+			current->children.insert(it, std::move(leaf));
+			++count;
+			return;
+		}
+
+		size_t shared{shared_length((*it)->label, name)};
+
+		/* If the name diverges partway along the edge, split the edge
+		 * so there's a node where it diverges. */
+		if (shared < (*it)->label.size()) {
+			auto split{std::make_unique<node>()};
+			split->label = (*it)->label.substr(0, shared);
+			(*it)->label.erase(0, shared);
+			split->children.push_back(std::move(*it));
+			*it = std::move(split);
+		}
+
+		current = it->get();
+		name.remove_prefix(shared);
+	}
+
+	if (!current->terminal && current != &root) {
+		current->terminal = true;
+		++count;
+	}
+}
+
+bool Cmd_trie::contains(std::string_view name) const
+{
+	const node* current{&root};
+
+	while (!name.empty()) {
+		auto it{find_child(*current, name[0])};
+		if (it == current->children.end() || (*it)->label[0] != name[0] ||
+			name.substr(0, (*it)->label.size()) != (*it)->label) {
+			return false;
+		}
+		name.remove_prefix((*it)->label.size());
+		current = it->get();
+	}
+
+	return current->terminal;
+}
+
+void Cmd_trie::collect(const node& current,
+					   std::string& path,
+					   std::vector<std::string>& matches)
+{
+	// A name ending here sorts before any longer name below it.
+	if (current.terminal) {
+		matches.push_back(path);
+	}
+	for (const auto& child : current.children) {
+		path.append(child->label);
+		collect(*child, path, matches);
+		path.resize(path.size() - child->label.size());
+	}
+}
+
+Cmd_trie::completion Cmd_trie::complete(std::string_view prefix) const
+{
+	completion result;
+	const node* current{&root};
+
+	// Walk down to the node at (or just past) the end of the prefix.
+	while (!prefix.empty()) {
+		auto it{find_child(*current, prefix[0])};
+		if (it == current->children.end() || (*it)->label[0] != prefix[0]) {
+			return completion();
+		}
+
+		size_t shared{shared_length((*it)->label, prefix)};
+		// The prefix ends partway along this edge, or matches it fully.
+		if (shared == prefix.size()) {
+			result.common.append((*it)->label);
+			current = it->get();
+			break;
+		}
+		// The prefix diverges from this edge, so nothing matches.
+		if (shared < (*it)->label.size()) {
+			return completion();
+		}
+
+		result.common.append((*it)->label);
+		prefix.remove_prefix(shared);
+		current = it->get();
+	}
+
+	// Everything below here shares the path, plus any unbranched edges.
+	std::string path{result.common};
+	collect(*current, path, result.matches);
+
+	while (!current->terminal && current->children.size() == 1) {
+		current = current->children.front().get();
+		result.common.append(current->label);
+	}
+
+	return result;
+}
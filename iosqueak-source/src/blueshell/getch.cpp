@@ -1,27 +1,13 @@
-#include <stdio.h>
-#include <termios.h>
-#include <unistd.h>
-
 #include "../include/iosqueak/blueshell.hpp"
 
-/* I found this online. I cannot remember where
- *  so I cannot give credit to whom it belongs */
-
+/* Returns the next key pressed. Inside of initial_shell(), the terminal
+ * is already in raw mode, and input is read in bulk. */
 int Blueshell::getch(void)
 {
-	int ch;
-	struct termios oldt, newt;
-
-	tcgetattr(STDIN_FILENO, &oldt);
-
-	newt = oldt;
-	newt.c_lflag &= ~(ICANON | ECHO);
-
-	tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-
-	ch = getchar();
-
-	tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-
-	return ch;
+	/* Once all of the waiting input is handled, show the result in
+	 * one write before waiting for more. */
+	if (terminal.available() == 0) {
+		line.flush();
+	}
+	return terminal.get();
 }
@@ -6,29 +6,40 @@ int Blueshell::history(std::deque<std::string>& searched_word)
 	/* If there is no word specified, print out
 	 * entire history. */
 	if (searched_word.empty()) {
-		std::for_each(previous_commands.rbegin(),
-					  previous_commands.rend(),
-					  [](const auto& cmd) {
-						  channel << cmd.first << "  " << cmd.second
-								  << IOCtrl::n << IOCtrl::end;
-					  });
+		for (size_t number{previous_commands.oldest()};
+			 number <= previous_commands.newest();
+			 ++number) {
+			std::optional<std::string_view> command{
+				previous_commands.find(number)};
+			if (command) {
+				channel << number << "  " << *command << IOCtrl::n
+						<< IOCtrl::end;
+			}
+		}
 	} else {
 		// Loop through searched_word for searched items.
 		for (auto& word : searched_word) {
-			// Search for any matching command in previous_commands container.
-			std::for_each(previous_commands.rbegin(),
-						  previous_commands.rend(),
-						  [this, &word](auto& searched) {
-							  if (word ==
-								  Blueshell::tokens(searched.second).front()) {
-								  channel << searched.first << ' '
-										  << searched.second << IOCtrl::n;
-							  }
-							  channel << IOCtrl::end;
-						  });
+			// Look up the commands starting with the word in the index.
+			const auto* numbers{previous_commands.starting_with(word)};
+			if (numbers == nullptr) {
+				continue;
+			}
+			for (size_t number : *numbers) {
+				std::optional<std::string_view> command{
+					previous_commands.find(number)};
+				if (command) {
+					channel << number << ' ' << *command << IOCtrl::n;
+				}
+			}
+			channel << IOCtrl::end;
 		}
 	}
 	channel << "Use ! to recall a command (eg. !2)" << IOCtrl::endl;
 
 	return 0;
 }
+
+bool Blueshell::load_history(const std::string& path)
+{
+	return previous_commands.open(path);
+}
@@ -6,6 +6,10 @@ void Blueshell::initial_shell()
 	// Register the default commands.
 	Blueshell::registerdefaults();
 
+	/* Stay in raw mode until we leave the shell, instead of switching
+	 * for every keypress. The terminal is restored on the way out. */
+	RawTerminal::session raw(terminal);
+
 	Blueshell::clear_screen(empty_container);
 
 	channel << IOFormatTextBG::black << IOFormatTextFG::green
@@ -50,6 +54,12 @@ void Blueshell::initial_shell()
 					break;
 				}
 
+				// Check if Ctrl-R was pressed, to search the history.
+				case 18: {
+					returned_key = Blueshell::reverse_search(check_command);
+					continue;
+				}
+
 				// Check if arrow key was pressed.
 				case 27: {
 					returned_key = Blueshell::arrow_press(check_command);
@@ -95,14 +105,27 @@ void Blueshell::initial_shell()
 		 *  typed command. */
 		command = (!prev_cmd_holder.empty() ? prev_cmd_holder : check_command);
 
+		/* Show the finished line before anything else is printed. Then
+		 * it is left alone, until the next line is started. */
+		line.flush();
+		line.invalidate();
+
 		// If sent command is to exit or quit shell.
 		if (command == "quit" || command == "exit") {
 			channel << "\nLeaving " << shell_name << " shell." << IOCtrl::endl;
+			// Any jobs left running print as usual from now on.
+			Blueshell::capture_output(false);
 			return;
 		}
 
-		// Process the command to break into strings if options are provided.
+		/* Process the command to break into strings if options are provided.
+		 * Commands run with the terminal's usual settings. */
+		bool was_raw{terminal.is_raw()};
+		terminal.leave();
 		Blueshell::process_command(command);
+		if (was_raw) {
+			terminal.enter();
+		}
 
 		// Reset commands to empty string.
 		check_command = std::string();
@@ -0,0 +1,124 @@
+#include <charconv>
+
+#include "../include/iosqueak/blueshell.hpp"
+
+namespace
+{
+// Describe how a job is doing, as shown by 'jobs'.
+std::string describe(const Cmd_jobs::job& job)
+{
+	switch (job.state) {
+		case Cmd_jobs::job_state::queued:
+			return "Queued";
+		case Cmd_jobs::job_state::running:
+			return "Running";
+		case Cmd_jobs::job_state::cancelled:
+			return "Cancelled";
+		case Cmd_jobs::job_state::done:
+			break;
+	}
+	return (job.status == 0) ? "Done" : "Exit " + std::to_string(job.status);
+}
+}  // namespace
+
+int Blueshell::start_job(std::string_view sent_command,
+						 std::function<int()> work)
+{
+	Blueshell::capture_output(true);
+	size_t id{jobs.start(std::string(sent_command), std::move(work))};
+	channel << IOCtrl::n << '[' << id << "] " << sent_command << IOCtrl::endl;
+	return 0;
+}
+
+void Blueshell::capture_output(bool capture)
+{
+	if (capture == capturing) {
+		return;
+	}
+	capturing = capture;
+
+	if (capture) {
+		// Say when each job finishes, wherever the shell is at.
+		jobs.on_finish([](const Cmd_jobs::job& job) {
+			channel << '[' << job.id << "] " << describe(job) << "  "
+					<< job.command << IOCtrl::endl;
+		});
+		// Show only what the channel would have echoed itself.
+		saved_echo = channel.get_echo_mode();
+		saved_vrb = channel.get_echo_vrb();
+		saved_cat = channel.get_echo_cat();
+		if (saved_echo != IOEchoMode::none) {
+			capture_handle = channel.signal_full_view.append(
+				[this](std::string_view msg, IOVrb vrb, IOCat cat) {
+					if (vrb <= saved_vrb && flags_check(saved_cat, cat)) {
+						line.print_above(msg);
+					}
+				});
+		}
+		channel.configure_echo(IOEchoMode::none, saved_vrb, saved_cat);
+	} else {
+		if (saved_echo != IOEchoMode::none) {
+			channel.signal_full_view.remove(capture_handle);
+		}
+		channel.configure_echo(saved_echo, saved_vrb, saved_cat);
+	}
+}
+
+int Blueshell::list_jobs(arguments&)
+{
+	channel << IOCtrl::n;
+	for (const Cmd_jobs::job& job : jobs.list()) {
+		channel << '[' << job.id << "] " << describe(job) << "  "
+				<< job.command << IOCtrl::n;
+	}
+	channel << IOCtrl::end;
+
+	// Finished jobs are only listed once.
+	jobs.forget_finished();
+	return 0;
+}
+
+int Blueshell::wait_jobs(const Cmd_args& args)
+{
+	// With no job numbers, wait for all of them.
+	std::vector<size_t> ids;
+	if (args.rest().empty()) {
+		for (const Cmd_jobs::job& job : jobs.list()) {
+			ids.push_back(job.id);
+		}
+	}
+	for (const std::string& word : args.rest()) {
+		size_t id{0};
+		const char* end{word.data() + word.size()};
+		auto parsed{std::from_chars(word.data(), end, id)};
+		if (parsed.ec != std::errc() || parsed.ptr != end) {
+			channel << IOCtrl::n << "Invalid job number: '" << word << "'"
+					<< IOCtrl::endl;
+			return wrong_arguments;
+		}
+		ids.push_back(id);
+	}
+
+	// Returns what the last job waited for returned, like the POSIX shell.
+	int status{0};
+	for (size_t id : ids) {
+		std::optional<Cmd_jobs::job> job{jobs.wait(id)};
+		if (!job) {
+			channel << IOCtrl::n << "No job " << id << IOCtrl::endl;
+			status = 127;
+			continue;
+		}
+		status = job->status;
+	}
+	return status;
+}
+
+int Blueshell::cancel_job(const Cmd_args& args)
+{
+	long long id{args.integer(0)};
+	if (id <= 0 || !jobs.cancel(static_cast<size_t>(id))) {
+		channel << IOCtrl::n << "No running job " << id << IOCtrl::endl;
+		return 1;
+	}
+	return 0;
+}
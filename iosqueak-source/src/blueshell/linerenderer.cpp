@@ -0,0 +1,147 @@
+#include "iosqueak/linerenderer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+
+void LineRenderer::move_cursor(size_t from, size_t to)
+{
+	if (from == to) {
+		return;
+	}
+	// "\x1b[<n>C" moves right, "\x1b[<n>D" moves left.
+	pending.append("\x1b[");
+	pending.append(std::to_string((to > from) ? to - from : from - to));
+	pending.push_back((to > from) ? 'C' : 'D');
+}
+
+void LineRenderer::render(std::string_view text, size_t position)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	if (position > text.size()) {
+		position = text.size();
+	}
+
+	// If we don't know what's on screen, clear the line and draw it all.
+	if (!valid) {
+		pending.append("\r\x1b[2K");
+		pending.append(prompt);
+		pending.append(text);
+		shown.assign(text);
+		cursor = shown.size();
+		valid = true;
+		move_cursor(cursor, position);
+		cursor = position;
+		return;
+	}
+
+	// Find the part that changed, between the unchanged start and end.
+	size_t start{0};
+	size_t limit{std::min(shown.size(), text.size())};
+	while (start < limit && shown[start] == text[start]) {
+		++start;
+	}
+	size_t end{0};
+	while (end < limit - start &&
+		   shown[shown.size() - 1 - end] == text[text.size() - 1 - end]) {
+		++end;
+	}
+	size_t old_len{shown.size() - start - end};
+	size_t new_len{text.size() - start - end};
+
+	if (old_len > 0 || new_len > 0) {
+		move_cursor(cursor, start);
+		cursor = start;
+
+		// Overwrite the characters present in both versions.
+		size_t common{std::min(old_len, new_len)};
+		pending.append(text.substr(start, common));
+		cursor += common;
+
+		if (new_len > old_len) {
+			// Make room for the extra characters, unless at the end.
+			if (end > 0) {
+				pending.append("\x1b[");
+				pending.append(std::to_string(new_len - old_len));
+				pending.push_back('@');
+			}
+			pending.append(text.substr(cursor, new_len - old_len));
+			cursor += new_len - old_len;
+		} else if (old_len > new_len) {
+			// Remove the leftover characters, pulling the rest back.
+			if (end > 0) {
+				pending.append("\x1b[");
+				pending.append(std::to_string(old_len - new_len));
+				pending.push_back('P');
+			} else {
+				pending.append("\x1b[K");
+			}
+		}
+		shown.assign(text);
+	}
+
+	move_cursor(cursor, position);
+	cursor = position;
+}
+
+void LineRenderer::flush()
+{
+	/* Wait for the channel first, without the lock: its writer thread
+	 * may be printing above the line. */
+	chan.flush();
+
+	std::lock_guard<std::mutex> guard(lock);
+	write_pending();
+}
+
+void LineRenderer::print_above(std::string_view text)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	if (!valid) {
+		pending.append(text);
+		write_pending();
+		return;
+	}
+
+	// Redrawing the line makes any queued updates to it unnecessary.
+	pending.assign("\r\x1b[2K");
+	pending.append(text);
+	if (text.empty() || text.back() != '\n') {
+		pending.push_back('\n');
+	}
+	pending.append(prompt);
+	pending.append(shown);
+	move_cursor(shown.size(), cursor);
+	write_pending();
+}
+
+void LineRenderer::write_pending()
+{
+	if (pending.empty()) {
+		return;
+	}
+
+	// Anything printed through the standard streams goes first.
+	std::cout.flush();
+	fflush(stdout);
+
+	const char* data{pending.data()};
+	size_t left{pending.size()};
+	while (left > 0) {
+		ssize_t written{write(fd, data, left)};
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			// Nowhere to draw to; the next render redraws everything.
+			valid = false;
+			break;
+		}
+		data += written;
+		left -= static_cast<size_t>(written);
+	}
+	pending.clear();
+}
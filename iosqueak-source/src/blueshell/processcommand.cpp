@@ -1,56 +1,113 @@
 #include "../include/iosqueak/blueshell.hpp"
 
-void Blueshell::process_command(std::string& sent_command)
+namespace
 {
-	std::stringstream ss(sent_command);
-	std::string first_command;
+// Whether a command is one of the shell's own (see registerdefaults()).
+bool _is_builtin(std::string_view name)
+{
+	return name == "help" || name == "clear" || name == "history" ||
+		   name == "list" || name == "jobs" || name == "wait" ||
+		   name == "cancel";
+}
+}  // namespace
+
+int Blueshell::process_command(std::string& sent_command, bool record)
+{
+	// A trailing & runs the command in the background.
+	const char* whitespace{" \t\n\v\f\r"};
+	std::string_view line{sent_command};
+	bool background{false};
+	size_t last{line.find_last_not_of(whitespace)};
+	if (last != std::string_view::npos && line[last] == '&') {
+		background = true;
+		line = line.substr(0, last);
+		line = line.substr(0, line.find_last_not_of(whitespace) + 1);
+	}
 
 	// Take first word from sent command to check if valid command.
-	ss >> first_command;
+	const Cmd_tokenizer::tokens& words{Blueshell::tokens(line)};
+	std::string_view first_command;
+	if (!words.empty()) {
+		first_command = words.front();
+	}
 
 	// Check if the command is available, if not send "Unknown command".
-	auto it{stored_commands.send_element(first_command)};
-	if (it.func_name != "noname") {
-		// Break rest of sent_command into strings to process options/flags
-		arguments options{Blueshell::process_options(sent_command)};
-
-		// If function is help or history, skip argument check.
-		if (it.func_name == "help" || it.func_name == "history") {
-			it.func_command(options);
-			// Adds command to previous_commands container.
-			Blueshell::add_command(sent_command);
-			return;
+	const auto* it{stored_commands.find(first_command)};
+	if (it == nullptr) {
+		// If no matching commands, display error.
+		channel << IOCtrl::n << sent_command << " Unknown command"
+				<< IOCtrl::endl;
+		return unknown_command;
+	}
+
+	/* The shell's own commands use its state, which job threads mustn't
+	 * touch, so they always run in the foreground. */
+	if (background && _is_builtin(it->func_name)) {
+		background = false;
+	}
+
+	int status{0};
+	if (it->typed_command) {
+		// Commands with a schema get their arguments parsed instead.
+		Cmd_args args;
+		std::string error;
+		if (!it->schema.parse(words.data() + 1,
+							  words.size() - 1,
+							  args,
+							  error)) {
+			channel << IOCtrl::n << error << ". Usage: " << it->func_name
+					<< ' ' << it->schema.usage() << IOCtrl::endl;
+			return wrong_arguments;
 		}
 
-		// Check that the number of arguments match required amount.
-		if (!stored_commands.match_args(it.func_name, options.size())) {
-			channel << IOCtrl::n << "Wrong number of arguments. Required: "
-					<< it.number_of_args << ". You provided " << options.size()
-					<< '.' << IOCtrl::endl;
-			return;
+		if (background) {
+			status = Blueshell::start_job(
+				line,
+				[func{it->typed_command}, args{std::move(args)}]() {
+					return func(args);
+				});
 		} else {
-			/* Run the command, and add the command to the deque
-			 * of previously run commands. */
-			it.func_command(options);
-			// Adds command to previous_commands container.
-			Blueshell::add_command(sent_command);
+			status = it->typed_command(args);
 		}
 	} else {
-		// If no matching commands, display error.
-		channel << IOCtrl::n << sent_command << " Unknown command"
-				<< IOCtrl::endl;
+		// Copy the rest of the words to process options/flags
+		arguments options{Blueshell::process_options(words)};
+
+		/* Check that the number of arguments match required amount.
+		 * If function is help or history, skip argument check. */
+		if (it->func_name != "help" && it->func_name != "history" &&
+			it->number_of_args != options.size()) {
+			channel << IOCtrl::n << "Wrong number of arguments. Required: "
+					<< it->number_of_args << ". You provided "
+					<< options.size() << '.' << IOCtrl::endl;
+			return wrong_arguments;
+		}
+
+		if (background) {
+			status = Blueshell::start_job(
+				line,
+				[func{it->func_command},
+				 options{std::move(options)}]() mutable {
+					return func(options);
+				});
+		} else {
+			status = it->func_command(options);
+		}
+	}
+
+	// Adds command to previous_commands container.
+	if (record) {
+		Blueshell::add_command(sent_command);
 	}
+	return status;
 }
 
 void Blueshell::add_command(std::string& sent_command)
 {
 	/* Adds command to previous_commands container. If it is not
 	 *  the last command added to the deque. */
-	if (previous_commands.front().second != sent_command) {
-		previous_commands.push_front(
-			std::pair((previous_commands.size() == 0)
-						  ? 1
-						  : previous_commands.front().first + 1,
-					  sent_command));
+	if (previous_commands.empty() ||
+		previous_commands.front().second != sent_command) {
+		previous_commands.add(sent_command);
 	}
 }
@@ -0,0 +1,92 @@
+#include "iosqueak/rawterminal.hpp"
+
+#include <cerrno>
+
+bool RawTerminal::enter()
+{
+	if (raw || tcgetattr(fd, &saved) != 0) {
+		return false;
+	}
+
+	struct termios settings{saved};
+	settings.c_lflag &= ~(ICANON | ECHO);
+	// Return as soon as at least one byte is available.
+	settings.c_cc[VMIN] = 1;
+	settings.c_cc[VTIME] = 0;
+
+	if (tcsetattr(fd, TCSANOW, &settings) != 0) {
+		return false;
+	}
+	raw = true;
+	return true;
+}
+
+void RawTerminal::leave()
+{
+	if (raw) {
+		tcsetattr(fd, TCSANOW, &saved);
+		raw = false;
+	}
+}
+
+bool RawTerminal::fill()
+{
+	ssize_t got;
+	do {
+		got = read(fd, buffer, sizeof(buffer));
+	} while (got < 0 && errno == EINTR);
+
+	pos = 0;
+	len = (got > 0) ? static_cast<size_t>(got) : 0;
+	return len > 0;
+}
+
+int RawTerminal::peek()
+{
+	if (pos == len) {
+		// Outside of a session, only be raw for the duration of the read.
+		bool entered{enter()};
+		bool filled{fill()};
+		if (entered) {
+			leave();
+		}
+		if (!filled) {
+			return -1;
+		}
+	}
+	return static_cast<unsigned char>(buffer[pos]);
+}
+
+int RawTerminal::get()
+{
+	int ch{peek()};
+	if (ch >= 0) {
+		++pos;
+	}
+	return ch;
+}
+
+int RawTerminal::read_escape(int& param)
+{
+	param = 0;
+
+	int introducer{peek()};
+	if (introducer != '[' && introducer != 'O') {
+		return -1;
+	}
+	++pos;
+
+	/* Parameter bytes (digits and separators), then the final byte.
+	 * Only the first parameter is kept; modifiers are ignored. */
+	bool first{true};
+	int ch{get()};
+	while (ch >= 0x30 && ch <= 0x3F) {
+		if (ch == ';') {
+			first = false;
+		} else if (first && ch >= '0' && ch <= '9') {
+			param = param * 10 + (ch - '0');
+		}
+		ch = get();
+	}
+	return ch;
+}
@@ -23,3 +23,24 @@ int Blueshell::register_command(const std::string& func_name,
 
 	return 0;
 }
+
+int Blueshell::register_command(const std::string& func_name,
+								_typed_register func,
+								Cmd_schema schema,
+								const std::string& short_desc,
+								const std::string& long_desc)
+{
+	if (stored_commands.find_match(func_name)) {
+		channel << "Command " << func_name << " already stored."
+				<< IOCtrl::endl;
+		return 0;
+	}
+
+	stored_commands.add_command(func_name,
+								func,
+								std::move(schema),
+								short_desc,
+								long_desc);
+
+	return 0;
+}
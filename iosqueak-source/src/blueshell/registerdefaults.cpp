@@ -2,6 +2,12 @@
 
 void Blueshell::registerdefaults()
 {
+	// Only register them once, however the shell is started.
+	if (defaults_registered) {
+		return;
+	}
+	defaults_registered = true;
+
 	// Stores the commands in the stored_commands map.
 	Blueshell::
 		register_command("help",
@@ -28,4 +34,27 @@ void Blueshell::registerdefaults()
 						 "This command will show all the commands available. "
 						 "If not registered, they will not be listed here.",
 						 0);
+	Blueshell::
+		register_command("jobs",
+						 std::bind(&Blueshell::list_jobs, this, _1),
+						 "Shows the commands running in the background",
+						 "Commands ending in & run in the background. This "
+						 "command shows them by job number, and whether they "
+						 "are still running.",
+						 0);
+	Blueshell::
+		register_command("wait",
+						 std::bind(&Blueshell::wait_jobs, this, _1),
+						 Cmd_schema().variadic("jobs"),
+						 "Waits for background commands to finish",
+						 "Waits for the jobs with the given numbers (eg. "
+						 "wait 2), or for all of them if none are given.");
+	Blueshell::
+		register_command("cancel",
+						 std::bind(&Blueshell::cancel_job, this, _1),
+						 Cmd_schema().integer("job"),
+						 "Cancels a background command",
+						 "Cancels the job with the given number (eg. cancel "
+						 "2). Commands that haven't started yet never will; "
+						 "running commands stop if they check for it.");
 }
@@ -0,0 +1,76 @@
+#include "../include/iosqueak/blueshell.hpp"
+#include "iosqueak/cmd_search.hpp"
+
+size_t Blueshell::reverse_search(std::string& sent_command)
+{
+	// Keep what was typed, in case the search is cancelled (Ctrl-G).
+	std::string original{(!prev_cmd_holder.empty()) ? prev_cmd_holder
+													: sent_command};
+	Cmd_search search(previous_commands);
+
+	while (true) {
+		// Show the search through the usual line, with the cursor after it.
+		bool found{search.found()};
+		std::string display{(found || search.query().empty()) ? ""
+															  : "failed "};
+		display.insert(0, "(");
+		display.append("reverse-i-search)`");
+		display.append(search.query());
+		display.append("': ");
+		if (found) {
+			display.append(search.match());
+		}
+
+		int saved_moves{cursor_moves};
+		cursor_moves =
+			static_cast<int>((found ? search.match().size() : 0) + 3);
+		Blueshell::print_line(display);
+		cursor_moves = saved_moves;
+
+		int keypress{Blueshell::getch()};
+
+		// Type more of the query.
+		if (keypress >= 32 && keypress <= 126) {
+			search.push(static_cast<char>(keypress));
+			continue;
+		}
+
+		switch (keypress) {
+			// Backspace: go back to the matches for the shorter query.
+			case 8:
+			case 127: {
+				search.pop();
+				continue;
+			}
+
+			// Ctrl-R again: show the next best match, if there is one.
+			case 18: {
+				search.next();
+				continue;
+			}
+
+			// Ctrl-G: give up, and restore what was typed.
+			case 7: {
+				sent_command = original;
+				prev_cmd_holder = std::string();
+				cursor_moves = 0;
+				Blueshell::print_line(sent_command);
+				return 0;
+			}
+
+			// Any other key takes the match, and is then handled as usual.
+			default: {
+				if (found) {
+					sent_command = std::string(search.match());
+				} else {
+					sent_command = original;
+				}
+				prev_cmd_holder = std::string();
+				cursor_moves = 0;
+				vec_size = 0;
+				Blueshell::print_line(sent_command);
+				return (keypress < 0) ? 0 : static_cast<size_t>(keypress);
+			}
+		}
+	}
+}
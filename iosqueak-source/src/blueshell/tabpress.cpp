@@ -10,9 +10,11 @@ size_t Blueshell::tab_press(std::string& sent_command)
 	/* If tab is pressed again, and command is
 	 *  empty, display all available commands */
 	if (sent_command.empty()) {
+		line.flush();
+		line.invalidate();
 		channel << IOCtrl::n;
-		for (auto& cmd : stored_commands.get_set()) {
-			channel << cmd.func_name << '\t';
+		for (auto& cmd : stored_commands.complete("").matches) {
+			channel << cmd << '\t';
 		}
 		channel << IOCtrl::endl;
 	}
@@ -21,64 +23,45 @@ size_t Blueshell::tab_press(std::string& sent_command)
 	 *  empty, find any commands that start with
 	 *  command argument. */
 	if (!sent_command.empty()) {
-		std::string token{Blueshell::tokens(sent_command).back()};
+		// Complete the last word, or a new one after a space.
+		std::string_view token;
+		const Cmd_tokenizer::tokens& words{Blueshell::tokens(sent_command)};
+		if (!words.empty() && sent_command.back() != ' ') {
+			token = words.back();
+		}
 
-		std::deque<std::string> temp_cmds;
+		/* Looks for any commands that match the
+		 *  'command' sent, in sorted order. */
+		Cmd_trie::completion found{stored_commands.complete(token)};
 
-		for (auto& cmd : stored_commands.get_set()) {
-			/* Looks for any commands that match the
-			 *  'command' sent. */
-			if (cmd.func_name.rfind(token, 0) == 0) {
-				temp_cmds.push_back(cmd.func_name);
-			}
-		}
 		// If no matching commands, return.
-		if (temp_cmds.empty()) {
+		if (found.matches.empty()) {
 			return 0;
 		}
-		/* If there is only one item in the deque
-		 *  then print the command to the screen.
-		 *  Otherwise print all items in deque.*/
-		if (temp_cmds.size() == 1) {
-			while (sent_command.back() != ' ' && !sent_command.empty()) {
+		/* If there is only one match then print the
+		 *  command to the screen. Otherwise print all
+		 *  matches.*/
+		if (found.matches.size() == 1) {
+			while (!sent_command.empty() && sent_command.back() != ' ') {
 				sent_command.pop_back();
 			}
-			sent_command.append(temp_cmds.front());
+			sent_command.append(found.matches.front());
 			Blueshell::print_line(sent_command);
 			return 0;
 		} else {
+			line.flush();
+			line.invalidate();
 			channel << IOCtrl::n;
-			for (auto& cmd : temp_cmds) {
+			for (auto& cmd : found.matches) {
 				channel << cmd << '\t';
 			}
 		}
 		channel << IOCtrl::endl;
 
-		/* Fill in any chars that match each string in deque.
+		/* Fill in any chars that match each match.
 		 *  For example 'te' in words 'test' and 'tests' would
-		 *  fill in the partial typed command 'te' to 'test'.
-		 *  Get the size of the largest word, and use that for
-		 *  the end of the loop. */
-		for (size_t i{token.size()};
-			 i < std::size(*max_element(
-					 temp_cmds.begin(),
-					 temp_cmds.end(),
-					 [](auto& word1, auto& word2) {
-						 return word1.size() < word2.size();
-					 }));
-			 ++i) {
-			if (std::all_of(temp_cmds.begin(),
-							temp_cmds.end(),
-							[&](auto& word) {
-								return word[i] == temp_cmds[0][i];
-							})) {
-				sent_command.push_back(temp_cmds[0][i]);
-				continue;
-			}
-			break;
-		}
-
-		temp_cmds.clear();
+		 *  fill in the partial typed command 'te' to 'test'. */
+		sent_command.append(found.common, token.size());
 	}
 	return 0;
 }
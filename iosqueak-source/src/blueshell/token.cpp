@@ -1,14 +1,6 @@
 #include "../include/iosqueak/blueshell.hpp"
 
-std::deque<std::string> Blueshell::tokens(std::string& sent_command)
+const Cmd_tokenizer::tokens& Blueshell::tokens(std::string_view sent_command)
 {
-	std::stringstream stream(sent_command);
-	std::deque<std::string> tokens;
-
-	while (!stream.eof()) {
-		std::string ss;
-		stream >> ss;
-		tokens.push_back(ss);
-	}
-	return tokens;
+	return tokenizer.split(sent_command);
 }
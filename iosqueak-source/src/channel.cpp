@@ -1,18 +1,105 @@
 #include "iosqueak/channel.hpp"
 
+thread_local uint64_t Channel::last_id = 0;
+thread_local Channel::Builder* Channel::last_builder = nullptr;
+thread_local Channel::ThreadBuilders Channel::thread_builders;
+thread_local bool Channel::thread_exiting = false;
+
+namespace
+{
+/* Every live channel, by identifier, for exiting threads to release their
+ * builders from. Built on first use, so it outlives every channel. */
+struct _ChannelRegistry {
+	std::mutex lock;
+	std::unordered_map<uint64_t, Channel*> live;
+};
+
+_ChannelRegistry& _registry()
+{
+	static _ChannelRegistry registry;
+	return registry;
+}
+}  // namespace
+
+void Channel::enroll()
+{
+	_ChannelRegistry& registry = _registry();
+	std::lock_guard<std::mutex> guard(registry.lock);
+	registry.live[id] = this;
+}
+
+void Channel::withdraw()
+{
+	_ChannelRegistry& registry = _registry();
+	std::lock_guard<std::mutex> guard(registry.lock);
+	registry.live.erase(id);
+}
+
+Channel::ThreadBuilders::~ThreadBuilders()
+{
+	thread_exiting = true;
+	last_id = 0;
+	last_builder = nullptr;
+
+	const std::thread::id self = std::this_thread::get_id();
+	_ChannelRegistry& registry = _registry();
+	// Holding the registry keeps the channels from being destroyed meanwhile.
+	std::lock_guard<std::mutex> guard(registry.lock);
+	for (uint64_t channel_id : channels) {
+		auto found = registry.live.find(channel_id);
+		if (found != registry.live.end()) {
+			Channel* chan = found->second;
+			std::lock_guard<std::mutex> inner(chan->builders_lock);
+			chan->builders.erase(self);
+		}
+	}
+}
+
+Channel::Builder& Channel::builder()
+{
+	// Fast path: same channel as last time.
+	if (last_id == id) {
+		return *last_builder;
+	}
+
+	std::lock_guard<std::mutex> guard(builders_lock);
+	std::unique_ptr<Builder>& b = builders[std::this_thread::get_id()];
+	if (!b) {
+		b = std::make_unique<Builder>();
+		// Release it when this thread exits, unless that's happening now.
+		if (!thread_exiting) {
+			thread_builders.channels.push_back(id);
+		}
+	}
+	last_builder = b.get();
+	last_id = id;
+	return *last_builder;
+}
+
 bool Channel::can_parse()
 {
+	Builder& b = builder();
+
+	// If the processing rules changed, we have to check again.
+	unsigned int current = generation.load(std::memory_order_acquire);
+	if (b.generation != current) {
+		b.generation = current;
+		b.parse = maybe;
+	}
+
 	// If we aren't sure about the parsing condition...
-	if (~parse) {
+	if (~b.parse) {
 		/* Proceed if the verbosity is in range
 		 * and the category is set to parse. */
-		parse = ((vrb <= process_vrb) && flags_check(process_cat, cat)) ? true
-																		: false;
+		b.parse = ((b.vrb <= process_vrb.load()) &&
+				   flags_check(process_cat.load(), b.cat))
+					  ? true
+					  : false;
 	}
-	return parse;
+	return b.parse;
 }
 
-void Channel::flush()
+void Channel::flush_streams()
 {
 	/* TODO: For non-standard outputs, this should attach a bytecode to
 	 * tell external outputs to flush.
@@ -35,10 +122,23 @@ void Channel::flush()
 	}
 }
 
+void Channel::request_flush()
+{
+	if (dispatch_mode == IODispatchMode::async) {
+		/* Queue an empty message, so the writer thread flushes after
+		 * everything transmitted before it. */
+		Record rec;
+		rec.flush = true;
+		enqueue(std::move(rec));
+	} else {
+		flush_streams();
+	}
+}
+
 void Channel::move_cursor(const IOCursor& rhs)
 {
 	// TODO: Migrate to ioformat.hpp
-	if (this->fmt.standard() == IOFormatStandard::ansi) {
+	if (builder().fmt.standard() == IOFormatStandard::ansi) {
 		switch (rhs) {
 			case IOCursor::left:
 				// NOTE: Watch this. \x1B is allegedly equal to \e, check
@@ -62,7 +162,7 @@ void Channel::inject(char ch)
 	// Add any pending attributes to the buffer.
 	inject_attributes();
 	// Inject the character into the buffer.
-	buffer.push_back(ch);
+	builder().buffer.push_back(ch);
 }
 
 void Channel::inject(const char* str)
@@ -70,21 +170,83 @@ void Channel::inject(const char* str)
 	// Add any pending attributes to the buffer.
 	inject_attributes();
 	// Add the message to the buffer.
-	buffer.append(str);
+	builder().buffer.append(str);
+}
+
+void Channel::inject(const std::string& str)
+{
+	// Add any pending attributes to the buffer.
+	inject_attributes();
+	// Add the message to the buffer.
+	builder().buffer.append(str);
 }
 
-void Channel::transmit(bool keep)
+void Channel::transmit(bool keep, bool flush)
 {
+	Builder& b = builder();
+
 	// If the buffer is empty, abort transmission.
-	if (this->buffer == "") {
+	if (b.buffer.empty()) {
+		if (flush) {
+			request_flush();
+		}
 		return;
 	}
 
+	if (dispatch_mode == IODispatchMode::async) {
+		// Hand the message off to the writer thread.
+		Record rec;
+		rec.buffer = std::move(b.buffer);
+		rec.vrb = b.vrb;
+		rec.cat = b.cat;
+		rec.flush = flush;
+		enqueue(std::move(rec));
+	} else {
+		/* Take the message out of the builder, in case a callback writes
+		 * to this channel from this thread; swapping keeps the capacity. */
+		std::string msg;
+		msg.swap(b.buffer);
+
+		{
+			// This is the only point where threads have to take turns.
+			std::lock_guard<std::recursive_mutex> lock(dispatch_lock);
+			dispatch(msg, b.vrb, b.cat);
+
+			if (flush) {
+				flush_streams();
+			}
+		}
+
+		// Give the capacity back, unless a callback started a new message.
+		if (b.buffer.empty()) {
+			msg.clear();
+			b.buffer.swap(msg);
+		}
+	}
+
+	/* If we aren't flagged to keep formatting,
+	 * reset the system in prep for the next message.
+	 */
+	if (!keep) {
+		reset_flags();
+	}
+
+	/* The next message starts from scratch, so it will need any
+	 * attributes we kept. */
+	b.emitted = false;
+	b.dirty_attributes = b.fmt.has_attributes();
+
+	// Clear the message out in preparation for the next.
+	clear_buffer();
+}
+
+void Channel::dispatch(const std::string& msg, IOVrb msg_vrb, IOCat msg_cat)
+{
 	// Transmit to verbosity-based callbacks as appropriate.
-	switch (vrb) {
+	switch (msg_vrb) {
 		// Dispatch on the "quiet" verbosity signal.
 		case IOVrb::quiet:
-			signal_v_quiet(buffer, cat);
+			emit(signal_v_quiet, signal_v_quiet_view, msg, msg_cat);
 			/* Fall through, so the lower signals get emitted too.
 			 * This allows outputs to connect to the HIGHEST
 			 * verbosity they will allow, and get the lower verbosity
@@ -93,71 +255,71 @@ void Channel::transmit(bool keep)
 			[[fallthrough]];
 		// Dispatch on the "normal" verbosity signal.
 		case IOVrb::normal:
-			signal_v_normal(buffer, cat);
+			emit(signal_v_normal, signal_v_normal_view, msg, msg_cat);
 			[[fallthrough]];
 		// Dispatch on the "chatty" verbosity signal.
 		case IOVrb::chatty:
-			signal_v_chatty(buffer, cat);
+			emit(signal_v_chatty, signal_v_chatty_view, msg, msg_cat);
 			[[fallthrough]];
 		// Dispatch on the "TMI" verbosity signal.
 		case IOVrb::tmi:
-			signal_v_tmi(buffer, cat);
+			emit(signal_v_tmi, signal_v_tmi_view, msg, msg_cat);
 			break;
 	}
 
 	// Transmit to category-based callbacks.
 
 	// Dispatch on the "normal" category signal.
-	if (flags_check(cat, IOCat::normal)) {
-		signal_c_normal(buffer, vrb);
+	if (flags_check(msg_cat, IOCat::normal)) {
+		emit(signal_c_normal, signal_c_normal_view, msg, msg_vrb);
 	}
 	// Dispatch on the "debug" category signal.
-	if (flags_check(cat, IOCat::debug)) {
-		signal_c_debug(buffer, vrb);
+	if (flags_check(msg_cat, IOCat::debug)) {
+		emit(signal_c_debug, signal_c_debug_view, msg, msg_vrb);
 	}
 	// Dispatch on the "warning" category signal.
-	if (flags_check(cat, IOCat::warning)) {
-		signal_c_warning(buffer, vrb);
+	if (flags_check(msg_cat, IOCat::warning)) {
+		emit(signal_c_warning, signal_c_warning_view, msg, msg_vrb);
 	}
 	// Dispatch on the "error" category signal.
-	if (flags_check(cat, IOCat::error)) {
-		signal_c_error(buffer, vrb);
+	if (flags_check(msg_cat, IOCat::error)) {
+		emit(signal_c_error, signal_c_error_view, msg, msg_vrb);
 	}
 	// Dispatch on the "testing" category signal.
-	if (flags_check(cat, IOCat::testing)) {
-		signal_c_testing(buffer, vrb);
+	if (flags_check(msg_cat, IOCat::testing)) {
+		emit(signal_c_testing, signal_c_testing_view, msg, msg_vrb);
 	}
 
 	// Dispatch the general purpose signals.
-	signal_full(buffer, vrb, cat);
-	signal_all(buffer);
+	emit(signal_full, signal_full_view, msg, msg_vrb, msg_cat);
+	emit(signal_all, signal_all_view, msg);
 
 	// If we are supposed to be echoing...
 	if (echo_mode != IOEchoMode::none) {
 		// If the verbosity and category is correct...
-		if (vrb <= echo_vrb && static_cast<bool>(cat | echo_cat)) {
+		if (msg_vrb <= echo_vrb && static_cast<bool>(msg_cat | echo_cat)) {
 			// Transmit to standard output using the desired method.
 			switch (echo_mode) {
 				// If we're supposed to use `printf`...
 				case IOEchoMode::printf:
 					// For error messages, echo to stderr instead.
-					if (flags_check(cat, IOCat::error)) {
-						fprintf(stderr, "%s", buffer.c_str());
+					if (flags_check(msg_cat, IOCat::error)) {
+						fprintf(stderr, "%s", msg.c_str());
 					}
 					// For all other messages, echo to stdout.
 					else {
-						printf("%s", buffer.c_str());
+						printf("%s", msg.c_str());
 					}
 					break;
 				// If we're supposed to use std::cout...
 				case IOEchoMode::cout:
 					// For error messages, echo to stderr instead.
-					if (flags_check(cat, IOCat::error)) {
-						std::cerr << buffer.c_str();
+					if (flags_check(msg_cat, IOCat::error)) {
+						std::cerr << msg.c_str();
 					}
 					// For all other messages, echo to stdout.
 					else {
-						std::cout << buffer.c_str();
+						std::cout << msg.c_str();
 					}
 					break;
 				// This case is here for completeness...
@@ -168,50 +330,220 @@ void Channel::transmit(bool keep)
 			}
 		}
 	}
+}
 
-	/* If we aren't flagged to keep formatting,
-	 * reset the system in prep for the next message.
-	 */
-	if (!keep) {
-		reset_flags();
+void Channel::enqueue(Record&& rec)
+{
+	/* The writer thread can't wait for itself to drain the queue, so
+	 * anything it transmits (from inside a callback) is dispatched on the
+	 * spot, as it would be in synchronous mode. */
+	if (std::this_thread::get_id() == writer.get_id()) {
+		std::lock_guard<std::recursive_mutex> lock(dispatch_lock);
+		if (!rec.buffer.empty()) {
+			dispatch(rec.buffer, rec.vrb, rec.cat);
+		}
+		if (rec.flush) {
+			flush_streams();
+		}
+		return;
 	}
 
-	// Clear the message out in preparation for the next.
-	clear_buffer();
+	// Count the message before it is visible to the writer thread.
+	pending.fetch_add(1, std::memory_order_acq_rel);
+
+	while (!queue->try_push(std::move(rec))) {
+		switch (overflow_policy) {
+			case IOOverflowPolicy::block:
+				// Make sure the writer is draining, and give it a chance.
+				wake_writer();
+				std::this_thread::yield();
+				break;
+			case IOOverflowPolicy::drop_newest:
+				finish_pending();
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			case IOOverflowPolicy::drop_oldest: {
+				/* Discard from the front. If the writer got there first,
+				 * there's room now anyway. */
+				Record oldest;
+				if (queue->try_pop(oldest)) {
+					finish_pending();
+					dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+				break;
+			}
+		}
+	}
+
+	if (writer_sleeping.load()) {
+		wake_writer();
+	}
+}
+
+void Channel::wake_writer()
+{
+	/* Taking the lock ensures the writer is either not yet checking for
+	 * messages, or already waiting, so the notification can't be lost. */
+	{
+		std::lock_guard<std::mutex> lock(writer_lock);
+	}
+	writer_wake.notify_one();
+}
+
+void Channel::finish_pending()
+{
+	if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		// As in wake_writer(), the lock keeps the wakeup from being lost.
+		{
+			std::lock_guard<std::mutex> lock(drained_lock);
+		}
+		drained.notify_all();
+	}
+}
+
+void Channel::writer_loop()
+{
+	Record rec;
+
+	while (true) {
+		if (queue->try_pop(rec)) {
+			{
+				// Keep the echo settings from changing mid-message.
+				std::lock_guard<std::recursive_mutex> lock(dispatch_lock);
+				if (!rec.buffer.empty()) {
+					dispatch(rec.buffer, rec.vrb, rec.cat);
+				}
+				if (rec.flush) {
+					flush_streams();
+				}
+			}
+			finish_pending();
+			continue;
+		}
+
+		// Only stop once the queue has been fully drained.
+		if (!writer_running.load()) {
+			break;
+		}
+
+		// Sleep until there's something to do.
+		std::unique_lock<std::mutex> lock(writer_lock);
+		writer_sleeping.store(true);
+		/* The timeout is only a safety net; producers wake us as soon
+		 * as they see we're asleep. */
+		writer_wake.wait_for(lock, std::chrono::milliseconds(100), [this] {
+			return !queue->empty() || !writer_running.load();
+		});
+		writer_sleeping.store(false);
+	}
+}
+
+void Channel::stop_writer()
+{
+	if (!writer.joinable()) {
+		return;
+	}
+
+	writer_running.store(false);
+	wake_writer();
+	writer.join();
+
+	dispatch_mode = IODispatchMode::sync;
+	queue.reset();
+}
+
+void Channel::configure_dispatch(IODispatchMode mode,
+								 size_t capacity,
+								 IOOverflowPolicy policy)
+{
+	// Always drain and stop any existing writer, so nothing is lost.
+	stop_writer();
+
+	overflow_policy = policy;
+
+	if (mode == IODispatchMode::async) {
+		queue = std::make_unique<BoundedQueue<Record>>(capacity);
+		writer_running.store(true);
+		writer = std::thread(&Channel::writer_loop, this);
+	}
+
+	dispatch_mode = mode;
+}
+
+void Channel::flush()
+{
+	/* Wait for the writer thread to catch up, unless we ARE the writer
+	 * thread (such as from inside a callback), which would deadlock. */
+	if (dispatch_mode == IODispatchMode::async &&
+		std::this_thread::get_id() != writer.get_id()) {
+		wake_writer();
+		std::unique_lock<std::mutex> lock(drained_lock);
+		drained.wait(lock, [this] {
+			return pending.load(std::memory_order_acquire) == 0;
+		});
+	}
+
+	flush_streams();
 }
 
 void Channel::inject_attributes()
 {
+	Builder& b = builder();
 	// If we have no unapplied attributes, abort.
-	if (!dirty_attributes) {
+	if (!b.dirty_attributes) {
 		return;
 	}
-	// Otherwise, inject the attributes into the buffer.
-	buffer.append(this->fmt.format_string().c_str());
+
+	/* Otherwise, inject the attributes into the buffer. The first time in
+	 * a message, that's all of them, so the message stands on its own. */
+	if (b.emitted) {
+		b.buffer.append(b.fmt.format_string_from(b.emitted_attr,
+												 b.emitted_bg,
+												 b.emitted_fg));
+	} else {
+		b.buffer.append(b.fmt.format_string());
+	}
+
+	mark_attributes(b);
+}
+
+void Channel::mark_attributes(Builder& b)
+{
+	b.emitted = true;
+	b.emitted_attr = b.fmt.text_attr();
+	b.emitted_bg = b.fmt.text_bg();
+	b.emitted_fg = b.fmt.text_fg();
+	b.dirty_attributes = false;
 }
 
 void Channel::reset_attributes()
 {
+	Builder& b = builder();
 	// Reset the formatting attributes to their defaults.
-	this->fmt.reset_attributes();
+	b.fmt.reset_attributes();
 	// Immediately inject the reset attributes string!
-	this->inject(this->fmt.format_string().c_str());
+	b.dirty_attributes = false;
+	this->inject(b.fmt.format_string());
 	// We have no pending attributes now.
-	this->dirty_attributes = false;
+	mark_attributes(b);
 }
 
 void Channel::reset_flags()
 {
+	Builder& b = builder();
 	// Reset all the flags.
-	this->fmt = IOFormat();
+	b.fmt = IOFormat();
 
 	// Reset the verbosity and category.
-	vrb = IOVrb::normal;
-	cat = IOCat::normal;
+	b.vrb = IOVrb::normal;
+	b.cat = IOCat::normal;
+	b.parse = maybe;
 }
 
 void Channel::configure_echo(IOEchoMode mode, IOVrb vrb, IOCat cat)
 {
+	// Don't change the echo while another thread is echoing.
+	std::lock_guard<std::recursive_mutex> lock(dispatch_lock);
 	echo_mode = mode;
 	echo_vrb = vrb;
 	echo_cat = cat;
@@ -219,12 +551,13 @@ void Channel::configure_echo(IOEchoMode mode, IOVrb vrb, IOCat cat)
 
 void Channel::shut_up(const IOCat& cat)
 {
-	this->process_cat = this->process_cat & ~cat;
-	if (this->process_cat == IOCat::none) {
+	IOCat remaining = this->process_cat.load() & ~cat;
+	this->process_cat = remaining;
+	if (remaining == IOCat::none) {
 		printf("WARNING: All message categories have been turned off!\n");
 	}
 	// Revalidate parsing.
-	parse = maybe;
+	++generation;
 }
 
 void Channel::shut_up(const IOVrb& vrb)
@@ -232,15 +565,15 @@ void Channel::shut_up(const IOVrb& vrb)
 	// Set the processing verbosity.
 	process_vrb = vrb;
 	// Revalidate parsing.
-	parse = maybe;
+	++generation;
 }
 
 void Channel::speak_up(const IOCat& cat)
 {
 	// Allow the category through by turning on its bit.
-	this->process_cat = this->process_cat | cat;
+	this->process_cat = this->process_cat.load() | cat;
 	// Revalidate parsing.
-	parse = maybe;
+	++generation;
 }
 
 void Channel::speak_up(const IOVrb& vrb)
@@ -249,7 +582,7 @@ void Channel::speak_up(const IOVrb& vrb)
 	if (this->process_vrb < vrb) {
 		this->process_vrb = vrb;
 		// Revalidate parsing.
-		parse = maybe;
+		++generation;
 	}
 }
 
@@ -258,5 +591,5 @@ void Channel::speak_up()
 	process_vrb = IOVrb::tmi;
 	process_cat = IOCat::all;
 	// Revalidate parsing.
-	parse = maybe;
+	++generation;
 }
@@ -0,0 +1,294 @@
+#include "iosqueak/filesink.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <unistd.h>
+
+FileSink::FileSink(const std::string& file,
+				   IOVrb vrb,
+				   IOCat cat,
+				   size_t buffer_size,
+				   size_t buffer_count)
+: path(file), fd(-1),
+  block_size((buffer_size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT),
+  current(0), filter_vrb(vrb), filter_cat(cat), max_bytes(0), max_age(0),
+  keep(5), sync_policy(IOSyncPolicy::none), max_delay(1000), file_bytes(0),
+  error(0), attached(nullptr)
+{
+	if (block_size == 0) {
+		block_size = ALIGNMENT;
+	}
+	if (buffer_count == 0) {
+		buffer_count = 1;
+	}
+
+	blocks.resize(buffer_count);
+	for (Block& block : blocks) {
+		void* mem = nullptr;
+		if (posix_memalign(&mem, ALIGNMENT, block_size) != 0) {
+			for (Block& allocated : blocks) {
+				free(allocated.data);
+			}
+			throw std::bad_alloc();
+		}
+		block.data = static_cast<char*>(mem);
+	}
+
+	if (!open_file()) {
+		for (Block& block : blocks) {
+			free(block.data);
+		}
+		throw std::system_error(error, std::generic_category(),
+								"FileSink: cannot open " + path);
+	}
+	last_write = opened;
+}
+
+bool FileSink::open_file()
+{
+	do {
+		fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+				  0644);
+	} while (fd < 0 && errno == EINTR);
+
+	if (fd < 0) {
+		error = errno;
+		return false;
+	}
+
+	// Appending to an existing file counts toward its rotation size.
+	struct stat info;
+	file_bytes = (fstat(fd, &info) == 0) ? static_cast<size_t>(info.st_size)
+										 : 0;
+	opened = std::chrono::steady_clock::now();
+	return true;
+}
+
+void FileSink::close_file()
+{
+	if (fd < 0) {
+		return;
+	}
+	if (sync_policy != IOSyncPolicy::none) {
+		fdatasync(fd);
+	}
+	close(fd);
+	fd = -1;
+}
+
+void FileSink::rotate()
+{
+	write_out();
+	close_file();
+
+	if (keep == 0) {
+		unlink(path.c_str());
+	} else {
+		// Shift path.N-1 to path.N, ..., path to path.1, dropping the oldest.
+		for (unsigned int i = keep; i > 0; --i) {
+			std::string from =
+				(i == 1) ? path : path + "." + std::to_string(i - 1);
+			std::string to = path + "." + std::to_string(i);
+			rename(from.c_str(), to.c_str());
+		}
+	}
+
+	// If this fails, messages are discarded until the next rotation attempt.
+	open_file();
+}
+
+size_t FileSink::buffered() const
+{
+	size_t total = 0;
+	for (size_t i = 0; i <= current && i < blocks.size(); ++i) {
+		total += blocks[i].used;
+	}
+	return total;
+}
+
+void FileSink::buffer(const char* msg, size_t len)
+{
+	while (len > 0) {
+		Block& block = blocks[current];
+		size_t n = block_size - block.used;
+		if (n > len) {
+			n = len;
+		}
+		memcpy(block.data + block.used, msg, n);
+		block.used += n;
+		msg += n;
+		len -= n;
+
+		if (block.used == block_size && current + 1 < blocks.size()) {
+			++current;
+		}
+	}
+}
+
+void FileSink::write_out(const char* extra, size_t extra_len)
+{
+	std::vector<struct iovec> iov;
+	iov.reserve(blocks.size() + 1);
+	for (size_t i = 0; i <= current && i < blocks.size(); ++i) {
+		if (blocks[i].used > 0) {
+			iov.push_back({blocks[i].data, blocks[i].used});
+		}
+	}
+	if (extra_len > 0) {
+		iov.push_back({const_cast<char*>(extra), extra_len});
+	}
+
+	// Write everything, picking up where any partial write left off.
+	struct iovec* next = iov.data();
+	int count = static_cast<int>(iov.size());
+	while (count > 0 && fd >= 0) {
+		ssize_t written = writev(fd, next, count);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			// Give up on this batch rather than block the channel.
+			error = errno;
+			break;
+		}
+
+		file_bytes += static_cast<size_t>(written);
+
+		size_t remaining = static_cast<size_t>(written);
+		while (count > 0 && remaining >= next->iov_len) {
+			remaining -= next->iov_len;
+			++next;
+			--count;
+		}
+		if (count > 0) {
+			next->iov_base = static_cast<char*>(next->iov_base) + remaining;
+			next->iov_len -= remaining;
+		}
+	}
+
+	for (Block& block : blocks) {
+		block.used = 0;
+	}
+	current = 0;
+	last_write = std::chrono::steady_clock::now();
+
+	if (sync_policy == IOSyncPolicy::on_write && fd >= 0 && !iov.empty()) {
+		fdatasync(fd);
+	}
+}
+
+void FileSink::configure_filter(IOVrb vrb, IOCat cat)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	filter_vrb = vrb;
+	filter_cat = cat;
+}
+
+void FileSink::configure_rotation(size_t bytes,
+								  std::chrono::seconds age,
+								  unsigned int files)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	max_bytes = bytes;
+	max_age = age;
+	keep = files;
+}
+
+void FileSink::configure_sync(IOSyncPolicy policy)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	sync_policy = policy;
+}
+
+void FileSink::configure_delay(std::chrono::milliseconds delay)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	max_delay = delay;
+}
+
+void FileSink::attach(Channel& chan)
+{
+	detach();
+	handle = chan.signal_full_view.append(
+		[this](std::string_view msg, IOVrb vrb, IOCat cat) {
+			write(msg, vrb, cat);
+		});
+	attached = &chan;
+}
+
+void FileSink::detach()
+{
+	if (attached != nullptr) {
+		attached->signal_full_view.remove(handle);
+		attached = nullptr;
+	}
+}
+
+void FileSink::write(std::string_view msg, IOVrb vrb, IOCat cat)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	// Filter the same way as the channel's echo.
+	if (vrb > filter_vrb || !flags_check(filter_cat, cat)) {
+		return;
+	}
+
+	const char* data = msg.data();
+	size_t len = msg.length();
+	auto now = std::chrono::steady_clock::now();
+
+	// Start a new file if this one is too old, or this message won't fit.
+	if (max_age.count() > 0 && now - opened >= max_age) {
+		rotate();
+	}
+	size_t pending = file_bytes + buffered();
+	if (max_bytes > 0 && pending > 0 && pending + len > max_bytes) {
+		rotate();
+	}
+
+	if (fd < 0) {
+		return;
+	}
+
+	// If the message doesn't fit, write it out with the buffers in one call.
+	if (len > blocks.size() * block_size - buffered()) {
+		write_out(data, len);
+	} else {
+		buffer(data, len);
+		if (max_delay.count() == 0 || now - last_write >= max_delay) {
+			write_out();
+		}
+	}
+}
+
+void FileSink::flush()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	write_out();
+}
+
+int FileSink::last_error() const
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return error;
+}
+
+FileSink::~FileSink()
+{
+	detach();
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		write_out();
+		close_file();
+	}
+	for (Block& block : blocks) {
+		free(block.data);
+	}
+}
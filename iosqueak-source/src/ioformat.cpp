@@ -1,70 +1,90 @@
 #include "iosqueak/ioformat.hpp"
 
-const std::string IOFormat::text_attr(const IOFormatStandard& standard) const
+namespace
+{
+/// ANSI SGR parameters for each background color, by IOFormatTextBG value.
+const char* const ANSI_BG_CODES[] =
+	{";49", ";40", ";41", ";42", ";43", ";44", ";45", ";46", ";47"};
+
+/// ANSI SGR parameters for each foreground color, by IOFormatTextFG value.
+const char* const ANSI_FG_CODES[] =
+	{";39", ";30", ";31", ";32", ";33", ";34", ";35", ";36", ";37"};
+
+/** Append the ANSI SGR parameters for the given text attributes.
+ * \param str: the string to append to
+ * \param attr: the text attributes
+ */
+void append_ansi_attr(std::string& str, const IOFormatTextAttr& attr)
 {
-	std::string str_text_attr = "";
 	// https://mudhalla.net/tintin/info/ansicolor/
-	if (standard == IOFormatStandard::ansi) {
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::none)) {
-			str_text_attr += ";0";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::bold)) {
-			str_text_attr += ";1";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::faint)) {
-			str_text_attr += ";2";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::italic)) {
-			str_text_attr += ";3";
-		}
+	if (flags_check(attr, IOFormatTextAttr::none)) {
+		str += ";0";
+	}
+	if (flags_check(attr, IOFormatTextAttr::bold)) {
+		str += ";1";
+	}
+	if (flags_check(attr, IOFormatTextAttr::faint)) {
+		str += ";2";
+	}
+	if (flags_check(attr, IOFormatTextAttr::italic)) {
+		str += ";3";
+	}
 
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::underline)) {
-			str_text_attr += ";4";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::blink_slow)) {
-			str_text_attr += ";5";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::blink_fast)) {
-			str_text_attr += ";6";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::invert)) {
-			str_text_attr += ";7";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::invisible)) {
-			str_text_attr += ";8";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::double_underline)) {
-			str_text_attr += ";9";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::strikethrough)) {
-			str_text_attr += ";21";
-		}
+	if (flags_check(attr, IOFormatTextAttr::underline)) {
+		str += ";4";
+	}
+	if (flags_check(attr, IOFormatTextAttr::blink_slow)) {
+		str += ";5";
+	}
+	if (flags_check(attr, IOFormatTextAttr::blink_fast)) {
+		str += ";6";
+	}
+	if (flags_check(attr, IOFormatTextAttr::invert)) {
+		str += ";7";
+	}
+	if (flags_check(attr, IOFormatTextAttr::invisible)) {
+		str += ";8";
+	}
+	if (flags_check(attr, IOFormatTextAttr::double_underline)) {
+		str += ";9";
+	}
+	if (flags_check(attr, IOFormatTextAttr::strikethrough)) {
+		str += ";21";
+	}
 
-		// After turning ON features, turn OFF other features.
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::no_bold)) {
-			str_text_attr += ";22";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::no_italic)) {
-			str_text_attr += ";23";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::no_underline)) {
-			str_text_attr += ";24";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::no_slow_blink)) {
-			str_text_attr += ";25";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::no_fast_blink)) {
-			str_text_attr += ";26";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::no_invert)) {
-			str_text_attr += ";27";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::no_invisible)) {
-			str_text_attr += ";28";
-		}
-		if (flags_check(fmt_text_attr, IOFormatTextAttr::no_strikethorugh)) {
-			str_text_attr += ";28";
-		}
+	// After turning ON features, turn OFF other features.
+	if (flags_check(attr, IOFormatTextAttr::no_bold)) {
+		str += ";22";
+	}
+	if (flags_check(attr, IOFormatTextAttr::no_italic)) {
+		str += ";23";
+	}
+	if (flags_check(attr, IOFormatTextAttr::no_underline)) {
+		str += ";24";
+	}
+	if (flags_check(attr, IOFormatTextAttr::no_slow_blink)) {
+		str += ";25";
+	}
+	if (flags_check(attr, IOFormatTextAttr::no_fast_blink)) {
+		str += ";26";
+	}
+	if (flags_check(attr, IOFormatTextAttr::no_invert)) {
+		str += ";27";
+	}
+	if (flags_check(attr, IOFormatTextAttr::no_invisible)) {
+		str += ";28";
+	}
+	if (flags_check(attr, IOFormatTextAttr::no_strikethorugh)) {
+		str += ";28";
+	}
+}
+}  // namespace
+
+const std::string IOFormat::text_attr(const IOFormatStandard& standard) const
+{
+	std::string str_text_attr = "";
+	if (standard == IOFormatStandard::ansi) {
+		append_ansi_attr(str_text_attr, fmt_text_attr);
 	}
 	return str_text_attr;
 }
@@ -72,26 +92,7 @@ const std::string IOFormat::text_attr(const IOFormatStandard& standard) const
 const std::string IOFormat::text_bg(const IOFormatStandard& standard) const
 {
 	if (standard == IOFormatStandard::ansi) {
-		switch (fmt_text_bg) {
-			case IOFormatTextBG::none:
-				return ";49";
-			case IOFormatTextBG::black:
-				return ";40";
-			case IOFormatTextBG::red:
-				return ";41";
-			case IOFormatTextBG::green:
-				return ";42";
-			case IOFormatTextBG::yellow:
-				return ";43";
-			case IOFormatTextBG::blue:
-				return ";44";
-			case IOFormatTextBG::magenta:
-				return ";45";
-			case IOFormatTextBG::cyan:
-				return ";46";
-			case IOFormatTextBG::white:
-				return ";47";
-		}
+		return ANSI_BG_CODES[static_cast<int>(fmt_text_bg)];
 	}
 	return "";
 }
@@ -99,26 +100,7 @@ const std::string IOFormat::text_bg(const IOFormatStandard& standard) const
 const std::string IOFormat::text_fg(const IOFormatStandard& standard) const
 {
 	if (standard == IOFormatStandard::ansi) {
-		switch (fmt_text_fg) {
-			case IOFormatTextFG::none:
-				return ";39";
-			case IOFormatTextFG::black:
-				return ";30";
-			case IOFormatTextFG::red:
-				return ";31";
-			case IOFormatTextFG::green:
-				return ";32";
-			case IOFormatTextFG::yellow:
-				return ";33";
-			case IOFormatTextFG::blue:
-				return ";34";
-			case IOFormatTextFG::magenta:
-				return ";35";
-			case IOFormatTextFG::cyan:
-				return ";36";
-			case IOFormatTextFG::white:
-				return ";37";
-		}
+		return ANSI_FG_CODES[static_cast<int>(fmt_text_fg)];
 	}
 	return "";
 }
@@ -132,16 +114,47 @@ const std::string IOFormat::format_string(
 			break;
 		case IOFormatStandard::ansi:
 			format += "\33[";
-			format += text_attr(standard);
-			format += text_bg(standard);
-			format += text_fg(standard);
+			append_ansi_attr(format, fmt_text_attr);
+			format += ANSI_BG_CODES[static_cast<int>(fmt_text_bg)];
+			format += ANSI_FG_CODES[static_cast<int>(fmt_text_fg)];
 			format += "m";
 	}
 	return format;
 }
 
+const std::string IOFormat::format_string_from(const IOFormatTextAttr& attr,
+												const IOFormatTextBG& bg,
+												const IOFormatTextFG& fg) const
+{
+	// If nothing changed, there's nothing to do.
+	if (fmt_standard == IOFormatStandard::none ||
+		(attr == fmt_text_attr && bg == fmt_text_bg && fg == fmt_text_fg)) {
+		return "";
+	}
+
+	/* Attributes can only be turned off by starting over, which the
+	 * full format string does (its leading empty parameter is a reset). */
+	if (static_cast<bool>(attr & ~fmt_text_attr)) {
+		return format_string();
+	}
+
+	// Otherwise, only add what's new.
+	std::string params = "";
+	append_ansi_attr(params, fmt_text_attr & ~attr);
+	if (bg != fmt_text_bg) {
+		params += ANSI_BG_CODES[static_cast<int>(fmt_text_bg)];
+	}
+	if (fg != fmt_text_fg) {
+		params += ANSI_FG_CODES[static_cast<int>(fmt_text_fg)];
+	}
+
+	// Drop the leading separator, which would otherwise reset everything.
+	return "\33[" + params.substr(1) + "m";
+}
+
 void IOFormat::reset_attributes()
 {
+	this->fmt_format_dirty = true;
 	this->fmt_text_attr = IOFormatTextAttr::none;
 	this->fmt_text_fg = IOFormatTextFG::none;
 	this->fmt_text_bg = IOFormatTextBG::none;
@@ -163,5 +176,7 @@ IOFormat& IOFormat::operator=(const IOFormat& cpy)
 	fmt_text_attr = cpy.fmt_text_attr;
 	fmt_text_bg = cpy.fmt_text_bg;
 	fmt_text_fg = cpy.fmt_text_fg;
+	fmt_format_string = cpy.fmt_format_string;
+	fmt_format_dirty = cpy.fmt_format_dirty;
 	return *this;
 }
@@ -0,0 +1,342 @@
+#include "iosqueak/stringify/memory.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define IOSQUEAK_MEMORY_X86
+#endif
+
+namespace
+{
+/* The digits of every byte value, most significant first, so bytes are
+ * converted by copying instead of dividing. Bitsets print their lowest
+ * bit first, so they get a table of binary digits in that order. */
+struct _ByteDigitTables {
+	char hex_upper[256][2];
+	char hex_lower[256][2];
+	char oct[256][4];
+	char bin[256][8];
+	char bits[256][8];
+};
+
+constexpr _ByteDigitTables _make_byte_digit_tables()
+{
+	_ByteDigitTables tables{};
+	const char* upper = "0123456789ABCDEF";
+	const char* lower = "0123456789abcdef";
+	for (int byte = 0; byte < 256; ++byte) {
+		tables.hex_upper[byte][0] = upper[byte >> 4];
+		tables.hex_upper[byte][1] = upper[byte & 0xF];
+		tables.hex_lower[byte][0] = lower[byte >> 4];
+		tables.hex_lower[byte][1] = lower[byte & 0xF];
+		for (int i = 0; i < 4; ++i) {
+			int digit = (byte >> (9 - 3 * i)) & 7;
+			tables.oct[byte][i] = static_cast<char>('0' + digit);
+		}
+		for (int i = 0; i < 8; ++i) {
+			int bit = (byte >> (7 - i)) & 1;
+			tables.bin[byte][i] = static_cast<char>('0' + bit);
+			tables.bits[byte][i] = static_cast<char>('0' + ((byte >> i) & 1));
+		}
+	}
+	return tables;
+}
+
+constexpr _ByteDigitTables BYTE_DIGITS = _make_byte_digit_tables();
+
+/* Writes the digits of 'count' bytes, with no separators, starting from
+ * the last byte and working back to the first. */
+using _digits_kernel = void (*)(char*,
+								const uint8_t*,
+								size_t,
+								IOFormatBase,
+								IOFormatNumCase);
+
+void _digits_scalar(char* out,
+					const uint8_t* first,
+					size_t count,
+					IOFormatBase base,
+					IOFormatNumCase num_case)
+{
+	const uint8_t* byte = first + count;
+	switch (base) {
+		case IOFormatBase::bin:
+			while (byte != first) {
+				memcpy(out, BYTE_DIGITS.bin[*--byte], 8);
+				out += 8;
+			}
+			break;
+		case IOFormatBase::oct:
+			while (byte != first) {
+				memcpy(out, BYTE_DIGITS.oct[*--byte], 4);
+				out += 4;
+			}
+			break;
+		default: {
+			auto& table = (num_case == IOFormatNumCase::lower)
+							  ? BYTE_DIGITS.hex_lower
+							  : BYTE_DIGITS.hex_upper;
+			while (byte != first) {
+				memcpy(out, table[*--byte], 2);
+				out += 2;
+			}
+			break;
+		}
+	}
+}
+
+#ifdef IOSQUEAK_MEMORY_X86
+
+// Reverse the order of the 16 bytes in a vector.
+inline __m128i _reverse_sse2(__m128i v)
+{
+	v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+	return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+// Convert each 0-15 value in a vector to its hexadecimal digit.
+inline __m128i _nibbles_to_hex_sse2(__m128i nibbles, __m128i letter_offset)
+{
+	__m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+	__m128i digits = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+	return _mm_add_epi8(digits, _mm_and_si128(letters, letter_offset));
+}
+
+// Convert each byte, all of whose bits are the same as one, to '0' or '1'.
+inline __m128i _bits_to_binary_sse2(__m128i spread)
+{
+	const __m128i bits = _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1,
+									   -128, 64, 32, 16, 8, 4, 2, 1);
+	__m128i set = _mm_cmpeq_epi8(_mm_and_si128(spread, bits), bits);
+	// Where set is all ones (-1), '0' - set is '1'.
+	return _mm_sub_epi8(_mm_set1_epi8('0'), set);
+}
+
+void _digits_sse2(char* out,
+				  const uint8_t* first,
+				  size_t count,
+				  IOFormatBase base,
+				  IOFormatNumCase num_case)
+{
+	if (base == IOFormatBase::hex) {
+		const __m128i low = _mm_set1_epi8(0x0F);
+		const __m128i offset = _mm_set1_epi8(
+			(num_case == IOFormatNumCase::lower) ? 'a' - '0' - 10
+												 : 'A' - '0' - 10);
+		while (count >= 16) {
+			count -= 16;
+			__m128i v = _reverse_sse2(_mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(first + count)));
+			__m128i hi = _nibbles_to_hex_sse2(
+				_mm_and_si128(_mm_srli_epi16(v, 4), low), offset);
+			__m128i lo = _nibbles_to_hex_sse2(_mm_and_si128(v, low), offset);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+							 _mm_unpacklo_epi8(hi, lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16),
+							 _mm_unpackhi_epi8(hi, lo));
+			out += 32;
+		}
+	} else if (base == IOFormatBase::bin) {
+		while (count >= 16) {
+			count -= 16;
+			__m128i v = _reverse_sse2(_mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(first + count)));
+			// Spread each byte across eight, two bytes per vector.
+			__m128i halves[2] = {_mm_unpacklo_epi8(v, v),
+								 _mm_unpackhi_epi8(v, v)};
+			for (__m128i half : halves) {
+				__m128i quarters[2] = {_mm_unpacklo_epi8(half, half),
+									   _mm_unpackhi_epi8(half, half)};
+				for (__m128i quarter : quarters) {
+					_mm_storeu_si128(
+						reinterpret_cast<__m128i*>(out),
+						_bits_to_binary_sse2(
+							_mm_unpacklo_epi8(quarter, quarter)));
+					_mm_storeu_si128(
+						reinterpret_cast<__m128i*>(out + 16),
+						_bits_to_binary_sse2(
+							_mm_unpackhi_epi8(quarter, quarter)));
+					out += 32;
+				}
+			}
+		}
+	}
+
+	// Octal, and whatever is left over.
+	_digits_scalar(out, first, count, base, num_case);
+}
+
+__attribute__((target("avx2"))) void _digits_avx2(char* out,
+												  const uint8_t* first,
+												  size_t count,
+												  IOFormatBase base,
+												  IOFormatNumCase num_case)
+{
+	if (base == IOFormatBase::hex) {
+		const __m256i low = _mm256_set1_epi8(0x0F);
+		const __m256i nine = _mm256_set1_epi8(9);
+		const __m256i zero = _mm256_set1_epi8('0');
+		const __m256i offset = _mm256_set1_epi8(
+			(num_case == IOFormatNumCase::lower) ? 'a' - '0' - 10
+												 : 'A' - '0' - 10);
+		const __m256i reverse = _mm256_setr_epi8(
+			15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+			15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		while (count >= 32) {
+			count -= 32;
+			__m256i v = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(first + count));
+			// Reverse each half, then swap the halves.
+			v = _mm256_shuffle_epi8(v, reverse);
+			v = _mm256_permute2x128_si256(v, v, 0x01);
+
+			__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+			__m256i lo = _mm256_and_si256(v, low);
+			hi = _mm256_add_epi8(
+				_mm256_add_epi8(hi, zero),
+				_mm256_and_si256(_mm256_cmpgt_epi8(hi, nine), offset));
+			lo = _mm256_add_epi8(
+				_mm256_add_epi8(lo, zero),
+				_mm256_and_si256(_mm256_cmpgt_epi8(lo, nine), offset));
+
+			// Interleaving works within each half, so put them back in order.
+			__m256i first_half = _mm256_unpacklo_epi8(hi, lo);
+			__m256i second_half = _mm256_unpackhi_epi8(hi, lo);
+			_mm256_storeu_si256(
+				reinterpret_cast<__m256i*>(out),
+				_mm256_permute2x128_si256(first_half, second_half, 0x20));
+			_mm256_storeu_si256(
+				reinterpret_cast<__m256i*>(out + 32),
+				_mm256_permute2x128_si256(first_half, second_half, 0x31));
+			out += 64;
+		}
+	} else if (base == IOFormatBase::bin) {
+		const __m256i bits = _mm256_setr_epi8(
+			-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1,
+			-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+		// Spread the last of four bytes across the first eight, and so on.
+		const __m256i spread = _mm256_setr_epi8(
+			3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2,
+			1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m256i zero = _mm256_set1_epi8('0');
+		while (count >= 4) {
+			count -= 4;
+			int32_t word;
+			memcpy(&word, first + count, 4);
+			__m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(word), spread);
+			__m256i set = _mm256_cmpeq_epi8(_mm256_and_si256(v, bits), bits);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+								_mm256_sub_epi8(zero, set));
+			out += 32;
+		}
+	}
+
+	_digits_scalar(out, first, count, base, num_case);
+}
+
+#endif
+
+// Pick the fastest kernel the processor supports.
+_digits_kernel _select_digits_kernel()
+{
+#ifdef IOSQUEAK_MEMORY_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return _digits_avx2;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		return _digits_sse2;
+	}
+#endif
+	return _digits_scalar;
+}
+}  // namespace
+
+void _stringify_memory_to(std::string& buf,
+						  const uint8_t* data,
+						  size_t len,
+						  IOFormatMemSep sep,
+						  IOFormatBase base,
+						  IOFormatNumCase num_case)
+{
+	static const _digits_kernel kernel = _select_digits_kernel();
+
+	// This also rejects bases we can't dump in.
+	const size_t total = lengthify_memory(len, sep, base);
+	const size_t digits = lengthify_memory(1, IOFormatMemSep::none, base);
+
+	size_t start = buf.length();
+	buf.resize(start + total);
+	char* out = &buf[start];
+
+	const bool byte_sep = flags_check(sep, IOFormatMemSep::byte);
+	const bool word_sep = flags_check(sep, IOFormatMemSep::word);
+	if (!byte_sep && !word_sep) {
+		kernel(out, data, len, base, num_case);
+		return;
+	}
+
+	/* Convert a block at a time, then copy the digits out between the
+	 * separators. The bytes are output from last to first. */
+	const size_t BLOCK = 64;
+	char block[BLOCK * 8];
+	size_t done = 0;
+	while (done < len) {
+		size_t count = std::min(BLOCK, len - done);
+		kernel(block, data + len - done - count, count, base, num_case);
+
+		const char* digit = block;
+		for (size_t i = 0; i < count; ++i) {
+			memcpy(out, digit, digits);
+			out += digits;
+			digit += digits;
+			if (byte_sep) {
+				*out++ = ' ';
+			}
+			++done;
+			if (word_sep && done % 8 == 0) {
+				*out++ = '|';
+				if (byte_sep) {
+					*out++ = ' ';
+				}
+			}
+		}
+	}
+}
+
+char* _stringify_bits(char* out,
+					  const uint8_t* bytes,
+					  size_t count,
+					  IOFormatMemSep sep)
+{
+	const bool byte_sep = flags_check(sep, IOFormatMemSep::byte);
+	const bool word_sep = flags_check(sep, IOFormatMemSep::word);
+
+	// Full bytes, with their separators.
+	size_t full = count / 8;
+	for (size_t i = 0; i < full; ++i) {
+		memcpy(out, BYTE_DIGITS.bits[bytes[i]], 8);
+		out += 8;
+		if (byte_sep) {
+			*out++ = ' ';
+		}
+		// A word is 8 bytes.
+		if (word_sep && (i + 1) % 8 == 0) {
+			*out++ = '|';
+			if (byte_sep) {
+				*out++ = ' ';
+			}
+		}
+	}
+
+	// Leftover bits at the end of the bitset have no separator.
+	if (count % 8 != 0) {
+		memcpy(out, BYTE_DIGITS.bits[bytes[full]], count % 8);
+		out += count % 8;
+	}
+	return out;
+}
@@ -0,0 +1,139 @@
+#include "iosqueak/tools/hexdump.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+/// The most characters a row of the given width can take up.
+constexpr size_t _row_length(size_t width)
+{
+	// Offset, gap, "xx " per byte, a space per group, " |ascii|\n".
+	return 16 + 1 + (width * 3) + (width / 8) + 2 + width + 2;
+}
+
+const char* _numerals(IOFormatNumCase num_case)
+{
+	return (num_case == IOFormatNumCase::upper) ? "0123456789ABCDEF"
+												: "0123456789abcdef";
+}
+
+/// Write an offset with the given number of hex digits.
+char* _write_offset(char* out,
+				   uint64_t offset,
+				   int digits,
+				   const char* numerals)
+{
+	for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+		*out++ = numerals[(offset >> shift) & 0xF];
+	}
+	return out;
+}
+}  // namespace
+
+HexDump::HexDump(size_t row_width,
+				 bool collapse_repeats,
+				 IOFormatNumCase digit_case)
+: width(row_width), collapse(collapse_repeats), num_case(digit_case),
+  origin(0)
+{
+	if (width != 16 && width != 32) {
+		throw std::invalid_argument("HexDump: row width must be 16 or 32");
+	}
+}
+
+HexDump& HexDump::start_at(uint64_t offset)
+{
+	origin = offset;
+	return *this;
+}
+
+size_t HexDump::format_row(char* buf,
+						   const uint8_t* row,
+						   size_t count,
+						   uint64_t offset,
+						   int digits) const
+{
+	const char* numerals = _numerals(num_case);
+	char* out = _write_offset(buf, offset, digits, numerals);
+	*out++ = ' ';
+
+	for (size_t i = 0; i < width; ++i) {
+		// Separate each group of eight bytes with an extra space.
+		if (i % 8 == 0) {
+			*out++ = ' ';
+		}
+		if (i < count) {
+			*out++ = numerals[row[i] >> 4];
+			*out++ = numerals[row[i] & 0xF];
+		} else {
+			*out++ = ' ';
+			*out++ = ' ';
+		}
+		*out++ = ' ';
+	}
+
+	*out++ = ' ';
+	*out++ = '|';
+	for (size_t i = 0; i < count; ++i) {
+		// Only printable ASCII goes in the gutter.
+		*out++ = (row[i] >= 0x20 && row[i] < 0x7F) ? static_cast<char>(row[i])
+												   : '.';
+	}
+	*out++ = '|';
+	*out++ = '\n';
+
+	return static_cast<size_t>(out - buf);
+}
+
+void HexDump::dump(const void* data, size_t len, const sink& out) const
+{
+	if (data == nullptr || len == 0) {
+		return;
+	}
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	/* Widen the offset column only if the offsets need it. Compare without
+	 * adding, which could wrap around for offsets near the top. */
+	const uint64_t narrow = 0xFFFFFFFF;
+	int digits = (origin > narrow || len > narrow - origin) ? 16 : 8;
+
+	char buf[_row_length(MAX_WIDTH)];
+	bool repeating = false;
+
+	for (size_t pos = 0; pos < len; pos += width) {
+		size_t count = (len - pos < width) ? len - pos : width;
+
+		// A full row matching the one before it is part of a repeated run.
+		if (collapse && pos > 0 && count == width &&
+			memcmp(bytes + pos, bytes + pos - width, width) == 0) {
+			if (!repeating) {
+				out(std::string_view("*\n", 2));
+				repeating = true;
+			}
+			continue;
+		}
+		repeating = false;
+
+		size_t used = format_row(buf, bytes + pos, count, origin + pos, digits);
+		out(std::string_view(buf, used));
+	}
+
+	// Finish with the offset just past the end, as hexdump does.
+	char* end = _write_offset(buf, origin + len, digits, _numerals(num_case));
+	*end++ = '\n';
+	out(std::string_view(buf, static_cast<size_t>(end - buf)));
+}
+
+void HexDump::dump(const void* data, size_t len, Channel& chan) const
+{
+	std::string row;
+	row.reserve(_row_length(width));
+
+	dump(data, len, [&chan, &row](std::string_view line) {
+		// The channel supplies the newline itself.
+		row.assign(line.data(), line.size() - 1);
+		chan << row << (IOCtrl::send | IOCtrl::n);
+	});
+}
@@ -0,0 +1,250 @@
+#include "iosqueak/tools/memdiff.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+// Avoiding magic numbers: the bytes compared at once.
+constexpr size_t BLOCK = 16;
+
+/* Compare one block of two regions.
+ * Returns a mask with a bit set for every byte which differs. */
+inline uint32_t _block_mask(const uint8_t* lhs, const uint8_t* rhs)
+{
+#if defined(__SSE2__)
+	__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs));
+	__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs));
+	return ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) &
+		   0xFFFF;
+#else
+	// Compare a word at a time, and only look at bytes when one differs.
+	uint64_t a[2];
+	uint64_t b[2];
+	memcpy(a, lhs, BLOCK);
+	memcpy(b, rhs, BLOCK);
+	if (a[0] == b[0] && a[1] == b[1]) {
+		return 0;
+	}
+	uint32_t mask = 0;
+	for (size_t i = 0; i < BLOCK; ++i) {
+		mask |= static_cast<uint32_t>(lhs[i] != rhs[i]) << i;
+	}
+	return mask;
+#endif
+}
+
+/// Write an offset as hex digits.
+void _append_offset(std::string& buf, uint64_t offset, int digits)
+{
+	const char* numerals = "0123456789abcdef";
+	for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+		buf += numerals[(offset >> shift) & 0xF];
+	}
+}
+}  // namespace
+
+MemDiff::MemDiff(const MemLens& watch, size_t row_width, IOFormatTextFG color)
+: lens(watch), width(row_width), highlight(color)
+{
+	if (width != 16 && width != 32) {
+		throw std::invalid_argument("MemDiff: row width must be 16 or 32");
+	}
+
+	lens.read_live(after);
+}
+
+const std::vector<MemDiff::Range>& MemDiff::update()
+{
+	// Reuse the older snapshot's storage for the new one.
+	before.swap(after);
+	lens.read_live(after);
+
+	compare(MemSpan(before), MemSpan(after), ranges);
+	return ranges;
+}
+
+void MemDiff::compare(MemSpan lhs, MemSpan rhs, std::vector<Range>& out)
+{
+	out.clear();
+
+	size_t common = std::min(lhs.size(), rhs.size());
+	// The start of the range being built, if 'open'.
+	size_t start = 0;
+	bool open = false;
+
+	auto mark = [&](size_t pos, bool differs) {
+		if (differs && !open) {
+			start = pos;
+			open = true;
+		} else if (!differs && open) {
+			out.push_back(Range{start, pos - start});
+			open = false;
+		}
+	};
+
+	size_t pos = 0;
+	for (; pos + BLOCK <= common; pos += BLOCK) {
+		uint32_t mask = _block_mask(lhs.data() + pos, rhs.data() + pos);
+
+		// Most blocks are entirely the same or entirely changed.
+		if (mask == 0) {
+			mark(pos, false);
+		} else if (mask == 0xFFFF) {
+			mark(pos, true);
+		} else {
+			for (size_t i = 0; i < BLOCK; ++i) {
+				mark(pos + i, (mask >> i) & 1);
+			}
+		}
+	}
+	for (; pos < common; ++pos) {
+		mark(pos, lhs[pos] != rhs[pos]);
+	}
+
+	// Bytes only one region has count as changed.
+	size_t total = std::max(lhs.size(), rhs.size());
+	mark(common, common < total);
+	mark(total, false);
+}
+
+void MemDiff::dump_runs(const run_sink& out) const
+{
+	size_t total = std::max(before.size(), after.size());
+	int digits = (total > 0xFFFFFFFF) ? 16 : 8;
+	// Plain text waiting to be passed on as one run.
+	std::string text;
+	char digit[2];
+
+	auto flush = [&]() {
+		if (!text.empty()) {
+			out(std::string_view(text), false);
+			text.clear();
+		}
+	};
+	auto changed = [&](std::string_view run) {
+		flush();
+		out(run, true);
+	};
+
+	// Format one side of a row, marking the bytes which differ.
+	auto side = [&](char mark,
+					const std::vector<uint8_t>& bytes,
+					const std::vector<uint8_t>& other,
+					size_t row) {
+		size_t end = std::min(row + width, bytes.size());
+		auto differs = [&](size_t i) {
+			return i >= other.size() || bytes[i] != other[i];
+		};
+
+		text += mark;
+		_append_offset(text, row, digits);
+		text += ' ';
+
+		for (size_t i = row; i < row + width; ++i) {
+			if ((i - row) % 8 == 0) {
+				text += ' ';
+			}
+			if (i >= end) {
+				text += "   ";
+				continue;
+			}
+			digit[0] = "0123456789abcdef"[bytes[i] >> 4];
+			digit[1] = "0123456789abcdef"[bytes[i] & 0xF];
+			if (differs(i)) {
+				changed(std::string_view(digit, 2));
+			} else {
+				text.append(digit, 2);
+			}
+			text += ' ';
+		}
+
+		text += " |";
+		for (size_t i = row; i < end; ++i) {
+			digit[0] = (bytes[i] >= 0x20 && bytes[i] < 0x7F)
+						   ? static_cast<char>(bytes[i])
+						   : '.';
+			if (differs(i)) {
+				changed(std::string_view(digit, 1));
+			} else {
+				text += digit[0];
+			}
+		}
+		text += '|';
+		flush();
+		out(std::string_view("\n"), false);
+	};
+
+	// Show each row touched by a change once, in order.
+	size_t next = 0;
+	for (const Range& range : ranges) {
+		size_t row = std::max(next, range.offset / width * width);
+		for (; row < range.offset + range.length; row += width) {
+			side('-', before, after, row);
+			side('+', after, before, row);
+		}
+		next = row;
+	}
+}
+
+void MemDiff::dump(const sink& out, IOFormatStandard standard) const
+{
+	if (ranges.empty()) {
+		return;
+	}
+
+	// Switch the highlight color on, and back off again.
+	IOFormat fmt;
+	fmt << standard << highlight;
+	const std::string on = fmt.format_string();
+	fmt << IOFormatTextFG::none;
+	const std::string off = fmt.format_string_from(IOFormatTextAttr::none,
+												   IOFormatTextBG::none,
+												   highlight);
+
+	std::string line;
+	dump_runs([&](std::string_view run, bool changed) {
+		if (changed) {
+			line += on;
+			line.append(run);
+			line += off;
+			return;
+		}
+		line.append(run);
+		if (run == "\n") {
+			out(std::string_view(line));
+			line.clear();
+		}
+	});
+}
+
+void MemDiff::dump(Channel& chan) const
+{
+	if (ranges.empty()) {
+		return;
+	}
+
+	/* Let the channel format the highlighting, so it follows the channel's
+	 * standard, and return to whatever color the message was in. */
+	const IOFormatTextFG previous = chan.get_format().text_fg();
+	std::string text;
+	dump_runs([&](std::string_view run, bool changed) {
+		// The channel supplies the newline itself.
+		if (run == "\n") {
+			chan << (IOCtrl::send | IOCtrl::n);
+			return;
+		}
+		text.assign(run.data(), run.size());
+		if (changed) {
+			chan << highlight << text << previous;
+		} else {
+			chan << text;
+		}
+	});
+}
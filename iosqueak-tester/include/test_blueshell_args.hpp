@@ -0,0 +1,322 @@
+/** Tests for Blueshell: Command Arguments [IOSQueak]
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_BLUESHELL_ARGS_TESTS_HPP
+#define IOSQUEAK_BLUESHELL_ARGS_TESTS_HPP
+
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "goldilocks/assertions.hpp"
+#include "goldilocks/goldilocks.hpp"
+#include "iosqueak/cmd_args.hpp"
+
+/** Parse a list of words with a schema.
+ * \return true if they fit, else false (and `error` describes why)
+ */
+inline bool parse_args(const Cmd_schema& schema,
+					   std::initializer_list<std::string_view> words,
+					   Cmd_args& args,
+					   std::string& error)
+{
+	std::vector<std::string_view> list(words);
+	return schema.parse(list.data(), list.size(), args, error);
+}
+
+class Test_ArgsInteger : public Test
+{
+public:
+	Test_ArgsInteger() = default;
+
+	testdoc_t get_title() override { return "Test Cmd_schema (Integer)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Parse whole numbers, including the limits, and reject "
+			   "overflow, signs, spaces and trailing characters.";
+	}
+
+	bool run() override
+	{
+		Cmd_schema schema = Cmd_schema().integer("count");
+		Cmd_args args;
+		std::string error;
+
+		PL_ASSERT_TRUE(parse_args(schema, {"42"}, args, error));
+		PL_ASSERT_EQUAL(args.integer(0), 42);
+		PL_ASSERT_TRUE(parse_args(schema, {"-7"}, args, error));
+		PL_ASSERT_EQUAL(args.integer(0), -7);
+		PL_ASSERT_TRUE(
+			parse_args(schema, {"9223372036854775807"}, args, error));
+		PL_ASSERT_EQUAL(args.integer(0), 9223372036854775807LL);
+		PL_ASSERT_TRUE(
+			parse_args(schema, {"-9223372036854775808"}, args, error));
+		PL_ASSERT_EQUAL(args.integer(0), -9223372036854775807LL - 1);
+
+		for (std::string_view word : {"9223372036854775808",
+									  "-9223372036854775809",
+									  "12abc",
+									  "1.5",
+									  "0x10",
+									  "+1",
+									  " 1",
+									  "1 ",
+									  ""}) {
+			PL_ASSERT_TRUE(!parse_args(schema, {word}, args, error));
+			PL_ASSERT_EQUAL(error,
+							"Invalid count: '" + std::string(word) + "'");
+		}
+		return true;
+	}
+
+	~Test_ArgsInteger() = default;
+};
+
+class Test_ArgsReal : public Test
+{
+public:
+	Test_ArgsReal() = default;
+
+	testdoc_t get_title() override { return "Test Cmd_schema (Real)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Parse decimal numbers, and reject hexadecimal, infinity, NaN, "
+			   "out of range numbers, spaces and other decimal points.";
+	}
+
+	bool run() override
+	{
+		Cmd_schema schema = Cmd_schema().real("ratio");
+		Cmd_args args;
+		std::string error;
+
+		PL_ASSERT_TRUE(parse_args(schema, {"2.5"}, args, error));
+		PL_ASSERT_EQUAL(args.real(0), 2.5);
+		PL_ASSERT_TRUE(parse_args(schema, {"-0.25"}, args, error));
+		PL_ASSERT_EQUAL(args.real(0), -0.25);
+		PL_ASSERT_TRUE(parse_args(schema, {".5"}, args, error));
+		PL_ASSERT_EQUAL(args.real(0), 0.5);
+		PL_ASSERT_TRUE(parse_args(schema, {"1e3"}, args, error));
+		PL_ASSERT_EQUAL(args.real(0), 1000.0);
+		PL_ASSERT_TRUE(parse_args(schema, {"7"}, args, error));
+		PL_ASSERT_EQUAL(args.real(0), 7.0);
+
+		for (std::string_view word : {"nan",
+									  "inf",
+									  "-infinity",
+									  "0x1p3",
+									  "1e999",
+									  "1,5",
+									  "1.5x",
+									  "+1.5",
+									  " 1.5",
+									  "1e",
+									  "."}) {
+			PL_ASSERT_TRUE(!parse_args(schema, {word}, args, error));
+			PL_ASSERT_EQUAL(error,
+							"Invalid ratio: '" + std::string(word) + "'");
+		}
+		return true;
+	}
+
+	~Test_ArgsReal() = default;
+};
+
+class Test_ArgsWords : public Test
+{
+public:
+	Test_ArgsWords() = default;
+
+	testdoc_t get_title() override { return "Test Cmd_schema (Words)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Parse every boolean spelling, choices and text, and reject "
+			   "unknown booleans and choices.";
+	}
+
+	bool run() override
+	{
+		Cmd_schema schema = Cmd_schema()
+								.boolean("enabled")
+								.choice("mode", {"fast", "slow"})
+								.text("name");
+		Cmd_args args;
+		std::string error;
+
+		for (std::string_view word : {"true", "yes", "on", "1"}) {
+			PL_ASSERT_TRUE(
+				parse_args(schema, {word, "fast", "x"}, args, error));
+			PL_ASSERT_TRUE(args.boolean(0));
+		}
+		for (std::string_view word : {"false", "no", "off", "0"}) {
+			PL_ASSERT_TRUE(
+				parse_args(schema, {word, "fast", "x"}, args, error));
+			PL_ASSERT_TRUE(!args.boolean(0));
+		}
+		// Spellings are exact.
+		PL_ASSERT_TRUE(!parse_args(schema, {"True", "fast", "x"}, args, error));
+		PL_ASSERT_EQUAL(error, "Invalid enabled: 'True'");
+
+		PL_ASSERT_TRUE(parse_args(schema, {"on", "slow", "a b"}, args, error));
+		PL_ASSERT_EQUAL(args.choice(1), 1u);
+		PL_ASSERT_EQUAL(args.text(2), "a b");
+
+		PL_ASSERT_TRUE(!parse_args(schema, {"on", "medium", "x"}, args, error));
+		PL_ASSERT_EQUAL(error, "Invalid mode: 'medium'");
+		return true;
+	}
+
+	~Test_ArgsWords() = default;
+};
+
+class Test_ArgsStructure : public Test
+{
+public:
+	Test_ArgsStructure() = default;
+
+	testdoc_t get_title() override { return "Test Cmd_schema (Structure)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Check flags anywhere and after \"--\", unknown flags, missing "
+			   "and extra arguments, and collecting variadic arguments.";
+	}
+
+	bool run() override
+	{
+		Cmd_schema fixed =
+			Cmd_schema().integer("count").flag("force").flag("quiet");
+		Cmd_args args;
+		std::string error;
+
+		// Flags can come before or after the arguments.
+		PL_ASSERT_TRUE(parse_args(fixed, {"--quiet", "3"}, args, error));
+		PL_ASSERT_EQUAL(args.integer(0), 3);
+		PL_ASSERT_TRUE(args.flag("quiet"));
+		PL_ASSERT_TRUE(!args.flag("force"));
+		PL_ASSERT_TRUE(!args.flag("unknown"));
+
+		PL_ASSERT_TRUE(!parse_args(fixed, {"3", "--loud"}, args, error));
+		PL_ASSERT_EQUAL(error, "Unknown flag '--loud'");
+		PL_ASSERT_TRUE(!parse_args(fixed, {}, args, error));
+		PL_ASSERT_EQUAL(error, "Missing count");
+		PL_ASSERT_TRUE(!parse_args(fixed, {"3", "4"}, args, error));
+		PL_ASSERT_EQUAL(error, "Too many arguments");
+
+		// After "--", words that look like flags are arguments.
+		Cmd_schema named = Cmd_schema().text("name").flag("force");
+		PL_ASSERT_TRUE(parse_args(named, {"--", "--force"}, args, error));
+		PL_ASSERT_EQUAL(args.text(0), "--force");
+		PL_ASSERT_TRUE(!args.flag("force"));
+
+		// A variadic argument collects the words after the others.
+		Cmd_schema copy =
+			Cmd_schema().text("to").flag("force").variadic("files");
+		PL_ASSERT_TRUE(parse_args(copy, {"dir"}, args, error));
+		PL_ASSERT_TRUE(args.rest().empty());
+		PL_ASSERT_TRUE(parse_args(
+			copy, {"dir", "a", "--force", "b", "--", "--c"}, args, error));
+		PL_ASSERT_EQUAL(args.text(0), "dir");
+		PL_ASSERT_TRUE(args.flag("force"));
+		PL_ASSERT_EQUAL(args.rest().size(), 3u);
+		PL_ASSERT_EQUAL(args.rest()[0], "a");
+		PL_ASSERT_EQUAL(args.rest()[1], "b");
+		PL_ASSERT_EQUAL(args.rest()[2], "--c");
+		return true;
+	}
+
+	~Test_ArgsStructure() = default;
+};
+
+class Test_ArgsUsage : public Test
+{
+public:
+	Test_ArgsUsage() = default;
+
+	testdoc_t get_title() override { return "Test Cmd_schema::usage()"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Check the usage string of schemas with every kind of "
+			   "argument, and of an empty schema.";
+	}
+
+	bool run() override
+	{
+		PL_ASSERT_EQUAL(Cmd_schema().usage(), "");
+		PL_ASSERT_EQUAL(Cmd_schema()
+							.integer("count")
+							.real("ratio")
+							.boolean("on")
+							.choice("mode", {"fast", "slow"})
+							.text("name")
+							.flag("force")
+							.variadic("files")
+							.usage(),
+						"<count:int> <ratio:number> <on:bool> "
+						"<mode:fast|slow> <name:text> [--force] [files...]");
+		PL_ASSERT_EQUAL(Cmd_schema().variadic("words").usage(), "[words...]");
+		return true;
+	}
+
+	~Test_ArgsUsage() = default;
+};
+
+class TestSuite_BlueshellArgs : public TestSuite
+{
+public:
+	explicit TestSuite_BlueshellArgs() = default;
+
+	void load_tests() override;
+
+	testdoc_t get_title() override
+	{
+		return "IOSqueak: Blueshell Command Arguments";
+	}
+
+	~TestSuite_BlueshellArgs() = default;
+};
+
+#endif  // IOSQUEAK_BLUESHELL_ARGS_TESTS_HPP
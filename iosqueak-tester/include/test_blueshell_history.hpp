@@ -0,0 +1,413 @@
+/** Tests for Blueshell: History [IOSQueak]
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_BLUESHELL_HISTORY_TESTS_HPP
+#define IOSQUEAK_BLUESHELL_HISTORY_TESTS_HPP
+
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+#include "goldilocks/assertions.hpp"
+#include "goldilocks/goldilocks.hpp"
+#include "iosqueak/cmd_history.hpp"
+#include "iosqueak/cmd_search.hpp"
+
+/** Write a history log to a new temporary file.
+ * \return the path of the file, or an empty string on failure
+ */
+inline std::string write_history_log(const std::string& contents)
+{
+	char path[] = "/tmp/iosqueak-history-XXXXXX";
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		return std::string();
+	}
+	bool ok = write(fd, contents.data(), contents.size()) ==
+			  static_cast<ssize_t>(contents.size());
+	close(fd);
+	if (!ok) {
+		unlink(path);
+		return std::string();
+	}
+	return path;
+}
+
+class Test_HistoryLogGap : public Test
+{
+public:
+	Test_HistoryLogGap() = default;
+
+	testdoc_t get_title() override { return "Test History Log (Gap)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Load a log whose numbers skip ahead, and check that missing "
+			   "numbers aren't found and the rest are.";
+	}
+
+	bool run() override
+	{
+		std::string path = write_history_log("1 a\n2 b\n5 c\n");
+		PL_ASSERT_TRUE(!path.empty());
+
+		Cmd_history history(3);
+		bool opened = history.open(path);
+		// The open log stays readable.
+		unlink(path.c_str());
+		PL_ASSERT_TRUE(opened);
+
+		// Only the run after the gap is remembered...
+		PL_ASSERT_EQUAL(history.oldest(), 5u);
+		PL_ASSERT_EQUAL(history.newest(), 5u);
+		PL_ASSERT_EQUAL(history.find(5).value_or(""), "c");
+		PL_ASSERT_TRUE(!history.find(4));
+		PL_ASSERT_TRUE(!history.find(3));
+
+		// ...and the rest are still in the file.
+		PL_ASSERT_EQUAL(history.find(2).value_or(""), "b");
+		PL_ASSERT_EQUAL(history.find(1).value_or(""), "a");
+
+		PL_ASSERT_EQUAL(history.add("d"), 6u);
+		PL_ASSERT_EQUAL(history.find(6).value_or(""), "d");
+		return true;
+	}
+
+	~Test_HistoryLogGap() = default;
+};
+
+class Test_HistoryLogOrder : public Test
+{
+public:
+	Test_HistoryLogOrder() = default;
+
+	testdoc_t get_title() override { return "Test History Log (Order)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Load a log whose numbers repeat and step back, and check "
+			   "that the last consecutive run is remembered and indexed.";
+	}
+
+	bool run() override
+	{
+		std::string path =
+			write_history_log("7 git x\n3 ls\n3 git y\n4 git z\n5 make\n");
+		PL_ASSERT_TRUE(!path.empty());
+
+		Cmd_history history(2);
+		bool opened = history.open(path);
+		unlink(path.c_str());
+		PL_ASSERT_TRUE(opened);
+
+		PL_ASSERT_EQUAL(history.oldest(), 4u);
+		PL_ASSERT_EQUAL(history.newest(), 5u);
+		PL_ASSERT_EQUAL(history.find(4).value_or(""), "git z");
+		PL_ASSERT_EQUAL(history.find(5).value_or(""), "make");
+
+		const std::deque<size_t>* git = history.starting_with("git");
+		PL_ASSERT_TRUE(git != nullptr);
+		PL_ASSERT_EQUAL(git->size(), 1u);
+		PL_ASSERT_EQUAL(git->front(), 4u);
+
+		// Push the "git" command out of the ring.
+		history.add("ls");
+		PL_ASSERT_TRUE(history.starting_with("git") == nullptr);
+		return true;
+	}
+
+	~Test_HistoryLogOrder() = default;
+};
+
+class Test_HistoryLogRuns : public Test
+{
+public:
+	Test_HistoryLogRuns() = default;
+
+	testdoc_t get_title() override { return "Test History Log (Runs)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Load logs whose numbering starts over, and check that only "
+			   "the last run is searched, however far back it goes.";
+	}
+
+	bool run() override
+	{
+		// The numbering starts over, so 1 and 2 appear twice.
+		std::string path = write_history_log(
+			"1 a\n2 b\n3 c\n4 d\n5 e\n6 f\n1 g\n2 h\n3 i\n");
+		PL_ASSERT_TRUE(!path.empty());
+
+		Cmd_history history(2);
+		bool opened = history.open(path);
+		unlink(path.c_str());
+		PL_ASSERT_TRUE(opened);
+
+		PL_ASSERT_EQUAL(history.oldest(), 2u);
+		PL_ASSERT_EQUAL(history.find(1).value_or(""), "g");
+		PL_ASSERT_EQUAL(history.find(2).value_or(""), "h");
+		PL_ASSERT_TRUE(!history.find(4));
+
+		// The last run starts before what is read when the log is opened.
+		path = write_history_log("1 x\n2 y\n9 z\n1 a\n2 b\n3 c\n4 d\n");
+		PL_ASSERT_TRUE(!path.empty());
+
+		opened = history.open(path);
+		unlink(path.c_str());
+		PL_ASSERT_TRUE(opened);
+
+		PL_ASSERT_EQUAL(history.oldest(), 3u);
+		PL_ASSERT_EQUAL(history.find(1).value_or(""), "a");
+		PL_ASSERT_EQUAL(history.find(2).value_or(""), "b");
+		PL_ASSERT_EQUAL(history.find(4).value_or(""), "d");
+		return true;
+	}
+
+	~Test_HistoryLogRuns() = default;
+};
+
+class Test_HistoryLogEscape : public Test
+{
+public:
+	Test_HistoryLogEscape() = default;
+
+	testdoc_t get_title() override { return "Test History Log (Escape)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Add commands containing newlines and backslashes, and check "
+			   "that they stay on one line of the log and read back intact.";
+	}
+
+	bool run() override
+	{
+		std::string path = write_history_log("");
+		PL_ASSERT_TRUE(!path.empty());
+		bool ok = check(path);
+		unlink(path.c_str());
+		return ok;
+	}
+
+	bool check(const std::string& path)
+	{
+		{
+			Cmd_history history(1);
+			PL_ASSERT_TRUE(history.open(path));
+			history.add("echo a\\b");
+			history.add("echo one\ntwo\\n");
+			history.add("ls");
+			// Pushed out of the ring, so read back from the log.
+			PL_ASSERT_EQUAL(history.find(1).value_or(""), "echo a\\b");
+			PL_ASSERT_EQUAL(history.find(2).value_or(""),
+							"echo one\ntwo\\n");
+		}
+
+		std::ifstream file(path);
+		std::ostringstream log;
+		log << file.rdbuf();
+		PL_ASSERT_EQUAL(log.str(),
+						"1 echo a\\b\n2\techo one\\ntwo\\\\n\n3 ls\n");
+
+		// Escaped commands are also decoded when the log is opened.
+		Cmd_history history(2);
+		PL_ASSERT_TRUE(history.open(path));
+		PL_ASSERT_EQUAL(history.find(2).value_or(""), "echo one\ntwo\\n");
+		PL_ASSERT_EQUAL(history.find(3).value_or(""), "ls");
+		return true;
+	}
+
+	~Test_HistoryLogEscape() = default;
+};
+
+class Test_HistoryLogViews : public Test
+{
+public:
+	Test_HistoryLogViews() = default;
+
+	testdoc_t get_title() override { return "Test History Log (Views)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Find a command in the log, then make the log be mapped again, "
+			   "and check that the first command is still readable.";
+	}
+
+	bool run() override
+	{
+		std::string path = write_history_log("1 first\n2 second\n");
+		PL_ASSERT_TRUE(!path.empty());
+
+		Cmd_history history(1);
+		bool opened = history.open(path);
+		unlink(path.c_str());
+		PL_ASSERT_TRUE(opened);
+
+		std::string_view first = history.find(1).value_or("");
+		PL_ASSERT_EQUAL(first, "first");
+
+		// Commands added since the log was mapped need it mapped again.
+		history.add("third");
+		history.add("fourth");
+		PL_ASSERT_EQUAL(history.find(3).value_or(""), "third");
+		PL_ASSERT_EQUAL(first, "first");
+		return true;
+	}
+
+	~Test_HistoryLogViews() = default;
+};
+
+class Test_HistoryFuzzyScore : public Test
+{
+public:
+	Test_HistoryFuzzyScore() = default;
+
+	testdoc_t get_title() override { return "Test History Fuzzy Score"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Test that Cmd_history::fuzzy_score() matches subsequences "
+			   "regardless of case, and prefers starts of words and runs.";
+	}
+
+	bool run() override
+	{
+		// Not a subsequence.
+		PL_ASSERT_EQUAL(Cmd_history::fuzzy_score("gst", "ls"), -1);
+		PL_ASSERT_EQUAL(Cmd_history::fuzzy_score("tsg", "git status"), -1);
+
+		// Subsequences, ignoring case.
+		PL_ASSERT_TRUE(Cmd_history::fuzzy_score("gst", "git status") >= 0);
+		PL_ASSERT_EQUAL(Cmd_history::fuzzy_score("GST", "git status"),
+						Cmd_history::fuzzy_score("gst", "Git Status"));
+
+		// Starts of words beat the middle of one...
+		PL_ASSERT_TRUE(Cmd_history::fuzzy_score("gst", "git status") >
+					   Cmd_history::fuzzy_score("gst", "go test"));
+		// ...and a run of characters beats a scattered match.
+		PL_ASSERT_TRUE(Cmd_history::fuzzy_score("make", "make all") >
+					   Cmd_history::fuzzy_score("make", "mv a/keep e"));
+		return true;
+	}
+
+	~Test_HistoryFuzzyScore() = default;
+};
+
+class Test_HistorySearch : public Test
+{
+public:
+	Test_HistorySearch() = default;
+
+	testdoc_t get_title() override { return "Test History Search"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Type and erase queries in a Cmd_search, and check the "
+			   "ranking, the recency tie-break and that repeats are skipped.";
+	}
+
+	bool run() override
+	{
+		Cmd_history history(10);
+		history.add("git status");
+		history.add("make a");
+		history.add("go test");
+		history.add("make b");
+		history.add("ls -l");
+		history.add("make a");
+
+		Cmd_search search(history);
+		PL_ASSERT_TRUE(!search.found());
+
+		// The best score wins, although "go test" is more recent.
+		search.push('g');
+		search.push('s');
+		search.push('t');
+		PL_ASSERT_TRUE(search.found());
+		PL_ASSERT_EQUAL(search.match(), "git status");
+		PL_ASSERT_TRUE(search.next());
+		PL_ASSERT_EQUAL(search.match(), "go test");
+		PL_ASSERT_TRUE(!search.next());
+		PL_ASSERT_EQUAL(search.match(), "go test");
+
+		// Nothing matches, until the character is erased again.
+		search.push('x');
+		PL_ASSERT_TRUE(!search.found());
+		search.pop();
+		PL_ASSERT_TRUE(search.found());
+		PL_ASSERT_EQUAL(search.query(), "gst");
+		PL_ASSERT_EQUAL(search.match(), "git status");
+
+		// Equal scores go by recency, and repeats are shown only once.
+		while (!search.query().empty()) {
+			search.pop();
+		}
+		PL_ASSERT_TRUE(!search.found());
+		for (char ch : std::string("make")) {
+			search.push(ch);
+		}
+		PL_ASSERT_EQUAL(search.match(), "make a");
+		PL_ASSERT_TRUE(search.next());
+		PL_ASSERT_EQUAL(search.match(), "make b");
+		PL_ASSERT_TRUE(!search.next());
+		PL_ASSERT_EQUAL(search.match(), "make b");
+		return true;
+	}
+
+	~Test_HistorySearch() = default;
+};
+
+class TestSuite_BlueshellHistory : public TestSuite
+{
+public:
+	explicit TestSuite_BlueshellHistory() = default;
+
+	void load_tests() override;
+
+	testdoc_t get_title() override { return "IOSqueak: Blueshell History"; }
+
+	~TestSuite_BlueshellHistory() = default;
+};
+
+#endif  // IOSQUEAK_BLUESHELL_HISTORY_TESTS_HPP
@@ -0,0 +1,337 @@
+/** Tests for Blueshell: Jobs [IOSQueak]
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_BLUESHELL_JOBS_TESTS_HPP
+#define IOSQUEAK_BLUESHELL_JOBS_TESTS_HPP
+
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "goldilocks/assertions.hpp"
+#include "goldilocks/goldilocks.hpp"
+#include "iosqueak/cmd_jobs.hpp"
+
+/** Wait until a job has started running, or give up after a few seconds.
+ * \return true if it is running, else false
+ */
+inline bool wait_until_running(const Cmd_jobs& jobs, size_t id)
+{
+	for (int tries = 0; tries < 5000; ++tries) {
+		for (const Cmd_jobs::job& job : jobs.list()) {
+			if (job.id == id && job.state == Cmd_jobs::job_state::running) {
+				return true;
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+class Test_JobsStartWait : public Test
+{
+public:
+	Test_JobsStartWait() = default;
+
+	testdoc_t get_title() override { return "Test Cmd_jobs (Start, Wait)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Start jobs, wait for them, and check their numbers, states, "
+			   "statuses and the finish callback.";
+	}
+
+	bool run() override
+	{
+		Cmd_jobs jobs(2);
+		std::atomic<size_t> reported{0};
+		jobs.on_finish([&reported](const Cmd_jobs::job& job) {
+			reported += job.id;
+		});
+
+		size_t first = jobs.start("first", [] { return 0; });
+		size_t second = jobs.start("second", [] { return 7; });
+		PL_ASSERT_EQUAL(first, 1u);
+		PL_ASSERT_EQUAL(second, 2u);
+
+		std::optional<Cmd_jobs::job> job = jobs.wait(second);
+		PL_ASSERT_TRUE(job.has_value());
+		PL_ASSERT_EQUAL(job->command, "second");
+		PL_ASSERT_TRUE(job->state == Cmd_jobs::job_state::done);
+		PL_ASSERT_EQUAL(job->status, 7);
+
+		job = jobs.wait(first);
+		PL_ASSERT_TRUE(job.has_value());
+		PL_ASSERT_EQUAL(job->status, 0);
+		// The callback runs before anything waiting carries on.
+		PL_ASSERT_EQUAL(reported.load(), first + second);
+
+		// Waiting stops keeping the job.
+		PL_ASSERT_TRUE(!jobs.wait(first));
+		PL_ASSERT_TRUE(!jobs.wait(99));
+		PL_ASSERT_TRUE(jobs.list().empty());
+		return true;
+	}
+
+	~Test_JobsStartWait() = default;
+};
+
+class Test_JobsCancel : public Test
+{
+public:
+	Test_JobsCancel() = default;
+
+	testdoc_t get_title() override { return "Test Cmd_jobs (Cancel)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Cancel a queued job, which must never run, and a running job, "
+			   "which must see cancel_requested().";
+	}
+
+	bool run() override
+	{
+		// One thread, so the second job stays queued behind the first.
+		Cmd_jobs jobs(1);
+		std::atomic<bool> ran{false};
+
+		size_t running = jobs.start("running", [] {
+			while (!Cmd_jobs::cancel_requested()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			return 3;
+		});
+		size_t queued = jobs.start("queued", [&ran] {
+			ran = true;
+			return 0;
+		});
+		PL_ASSERT_TRUE(wait_until_running(jobs, running));
+		PL_ASSERT_TRUE(!Cmd_jobs::cancel_requested());
+
+		PL_ASSERT_TRUE(jobs.cancel(queued));
+		std::optional<Cmd_jobs::job> job = jobs.wait(queued);
+		PL_ASSERT_TRUE(job.has_value());
+		PL_ASSERT_TRUE(job->state == Cmd_jobs::job_state::cancelled);
+
+		PL_ASSERT_TRUE(jobs.cancel(running));
+		job = jobs.wait(running);
+		PL_ASSERT_TRUE(job.has_value());
+		PL_ASSERT_TRUE(job->state == Cmd_jobs::job_state::cancelled);
+		PL_ASSERT_EQUAL(job->status, 3);
+		PL_ASSERT_TRUE(!ran);
+
+		// Finished and unknown jobs can't be cancelled.
+		size_t done = jobs.start("done", [] { return 0; });
+		jobs.wait(done);
+		PL_ASSERT_TRUE(!jobs.cancel(done));
+		PL_ASSERT_TRUE(!jobs.cancel(99));
+		return true;
+	}
+
+	~Test_JobsCancel() = default;
+};
+
+class Test_JobsStop : public Test
+{
+public:
+	Test_JobsStop() = default;
+
+	testdoc_t get_title() override { return "Test Cmd_jobs::stop()"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Stop with jobs running and queued, and check that it joins "
+			   "the workers, cancels everything and runs nothing more.";
+	}
+
+	bool run() override
+	{
+		Cmd_jobs jobs(2);
+		std::atomic<int> started{0};
+		std::atomic<int> finished{0};
+		auto work = [&started, &finished] {
+			++started;
+			while (!Cmd_jobs::cancel_requested()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			++finished;
+			return 0;
+		};
+
+		std::vector<size_t> ids;
+		for (int i = 0; i < 4; ++i) {
+			ids.push_back(jobs.start("loop", work));
+		}
+		PL_ASSERT_TRUE(wait_until_running(jobs, ids[0]));
+		PL_ASSERT_TRUE(wait_until_running(jobs, ids[1]));
+
+		// Once stop() returns, every running job has returned.
+		jobs.stop();
+		PL_ASSERT_EQUAL(started.load(), 2);
+		PL_ASSERT_EQUAL(finished.load(), 2);
+		for (const Cmd_jobs::job& job : jobs.list()) {
+			PL_ASSERT_TRUE(job.state == Cmd_jobs::job_state::cancelled);
+		}
+
+		// The jobs can start again afterwards.
+		size_t again = jobs.start("again", [] { return 5; });
+		std::optional<Cmd_jobs::job> job = jobs.wait(again);
+		PL_ASSERT_TRUE(job.has_value());
+		PL_ASSERT_EQUAL(job->status, 5);
+		return true;
+	}
+
+	~Test_JobsStop() = default;
+};
+
+class Test_JobsForget : public Test
+{
+public:
+	Test_JobsForget() = default;
+
+	testdoc_t get_title() override
+	{
+		return "Test Cmd_jobs::forget_finished()";
+	}
+
+	testdoc_t get_docs() override
+	{
+		return "Forget the finished jobs while another is still running, "
+			   "and check that only the running one is kept.";
+	}
+
+	bool run() override
+	{
+		Cmd_jobs jobs(2);
+		std::promise<void> release;
+		std::shared_future<void> released = release.get_future().share();
+
+		size_t done = jobs.start("done", [] { return 0; });
+		size_t running = jobs.start("running", [released] {
+			released.wait();
+			return 0;
+		});
+		jobs.wait(done);
+		size_t also_done = jobs.start("also done", [] { return 0; });
+		PL_ASSERT_TRUE(wait_until_running(jobs, running));
+
+		// Let the last job finish without waiting for it (which forgets it).
+		bool finished = false;
+		for (int tries = 0; tries < 5000 && !finished; ++tries) {
+			for (const Cmd_jobs::job& job : jobs.list()) {
+				finished |= job.id == also_done &&
+							job.state == Cmd_jobs::job_state::done;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		PL_ASSERT_TRUE(finished);
+
+		jobs.forget_finished();
+		std::vector<Cmd_jobs::job> kept = jobs.list();
+		PL_ASSERT_EQUAL(kept.size(), 1u);
+		PL_ASSERT_EQUAL(kept[0].id, running);
+
+		release.set_value();
+		PL_ASSERT_TRUE(jobs.wait(running).has_value());
+		return true;
+	}
+
+	~Test_JobsForget() = default;
+};
+
+class Test_JobsFailure : public Test
+{
+public:
+	Test_JobsFailure() = default;
+
+	testdoc_t get_title() override { return "Test Cmd_jobs (Failure)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Run a job which throws and one which waits for itself, and "
+			   "check that neither stops the workers.";
+	}
+
+	bool run() override
+	{
+		Cmd_jobs jobs(1);
+
+		size_t throws = jobs.start("throws", []() -> int {
+			throw std::runtime_error("failed");
+		});
+		std::optional<Cmd_jobs::job> job = jobs.wait(throws);
+		PL_ASSERT_TRUE(job.has_value());
+		PL_ASSERT_TRUE(job->state == Cmd_jobs::job_state::done);
+		PL_ASSERT_EQUAL(job->status, Cmd_jobs::threw);
+
+		// A job waiting for itself gets nothing back, instead of hanging.
+		std::promise<size_t> own;
+		std::shared_future<size_t> own_id = own.get_future().share();
+		size_t waits = jobs.start("waits", [&jobs, own_id] {
+			return jobs.wait(own_id.get()).has_value() ? 1 : 0;
+		});
+		own.set_value(waits);
+		job = jobs.wait(waits);
+		PL_ASSERT_TRUE(job.has_value());
+		PL_ASSERT_EQUAL(job->status, 0);
+		return true;
+	}
+
+	~Test_JobsFailure() = default;
+};
+
+class TestSuite_BlueshellJobs : public TestSuite
+{
+public:
+	explicit TestSuite_BlueshellJobs() = default;
+
+	void load_tests() override;
+
+	testdoc_t get_title() override { return "IOSqueak: Blueshell Jobs"; }
+
+	~TestSuite_BlueshellJobs() = default;
+};
+
+#endif  // IOSQUEAK_BLUESHELL_JOBS_TESTS_HPP
@@ -0,0 +1,338 @@
+/** Tests for Blueshell: Tokenizer [IOSQueak]
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_BLUESHELL_TOKENIZER_TESTS_HPP
+#define IOSQUEAK_BLUESHELL_TOKENIZER_TESTS_HPP
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "goldilocks/assertions.hpp"
+#include "goldilocks/goldilocks.hpp"
+#include "iosqueak/cmd_tokenizer.hpp"
+
+/** A straightforward, character-at-a-time version of the tokenizer's
+ * rules, which the tokenizer is checked against.
+ */
+inline std::vector<std::string> reference_tokenize(std::string_view line)
+{
+	std::vector<std::string> words;
+	std::string word;
+	bool in_word = false;
+	char quote = '\0';
+
+	for (size_t i = 0; i < line.size(); ++i) {
+		char ch = line[i];
+		if (quote != '\0') {
+			if (ch == quote) {
+				quote = '\0';
+			} else if (ch == '\\' && i + 1 < line.size() &&
+					   (line[i + 1] == '"' || line[i + 1] == '\'' ||
+						line[i + 1] == '\\')) {
+				word += line[++i];
+			} else {
+				word += ch;
+			}
+		} else if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' ||
+				   ch == '\f' || ch == '\r') {
+			if (in_word) {
+				words.push_back(word);
+				word.clear();
+				in_word = false;
+			}
+		} else {
+			in_word = true;
+			if (ch == '"' || ch == '\'') {
+				quote = ch;
+			} else {
+				word += ch;
+			}
+		}
+	}
+	if (in_word) {
+		words.push_back(word);
+	}
+	return words;
+}
+
+/** The Blueshell::process_options() implementation prior to the
+ * single-pass tokenizer, kept only as a benchmark baseline.
+ */
+inline std::deque<std::string> legacy_process_options(std::string& command)
+{
+	std::deque<std::string> options;
+
+	std::string word;
+	for (size_t ch = 0; ch < command.size(); ++ch) {
+		if (command[ch] != '"' && command[ch] != '\'' && command[ch] != ' ') {
+			word.push_back(command[ch]);
+			continue;
+		}
+
+		if (command[ch] == '"' || command[ch] == '\'') {
+			int plus1 = ((ch + 1) < command.size()) ? 1 : 0;
+			int plus2 = ((ch + 2) < command.size())   ? 2
+						: ((ch + 1) < command.size()) ? 1
+													  : 0;
+
+			if (ch + 1 < command.size())
+				++ch;
+
+			while (command[ch] != '"' && command[ch] != '\'' &&
+				   (ch + 1) < command.size()) {
+				if (command[ch] == '\\' && command[ch + plus1] == '\\') {
+					word.push_back(command[ch + plus1]);
+					ch += plus2;
+				}
+				if (command[ch] == '\\' && (command[ch + plus1] == '"' ||
+											command[ch + plus1] == '\'')) {
+					word.push_back(command[ch + plus1]);
+					ch += plus2;
+					continue;
+				}
+				if (ch == command.size() - 1) {
+					word.push_back(command[ch]);
+				}
+				word.push_back(command[ch]);
+				if (ch + 1 < command.size())
+					++ch;
+			}
+			if (ch + 1 < command.size())
+				++ch;
+		}
+
+		if (command[ch] == ' ') {
+			options.push_back(word);
+			word = std::string();
+		}
+	}
+	options.push_back(word);
+	options.pop_front();
+
+	return options;
+}
+
+class Test_TokenizerViews : public Test
+{
+public:
+	Test_TokenizerViews() = default;
+
+	testdoc_t get_title() override { return "Test Tokenizer Views"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Check that plain and fully quoted words are views of the "
+			   "command line, and that escaped words are unquoted.";
+	}
+
+	bool run() override
+	{
+		const std::string line = "say  \"hello world\" it\\s 'a\\'b' x\"y z\"";
+		Cmd_tokenizer tokenizer;
+		const Cmd_tokenizer::tokens& words = tokenizer.split(line);
+
+		PL_ASSERT_EQUAL(words.size(), 5u);
+		PL_ASSERT_EQUAL(words[0], "say");
+		PL_ASSERT_EQUAL(words[1], "hello world");
+		PL_ASSERT_EQUAL(words[2], "it\\s");
+		PL_ASSERT_EQUAL(words[3], "a'b");
+		PL_ASSERT_EQUAL(words[4], "xy z");
+
+		// The words without escapes weren't copied.
+		PL_ASSERT_EQUAL(words[0].data(), line.data());
+		PL_ASSERT_EQUAL(words[1].data(), line.data() + 6);
+		PL_ASSERT_EQUAL(words[2].data(), line.data() + 19);
+
+		PL_ASSERT_EQUAL(tokenizer.first("  \t'quoted name' arg"),
+						"quoted name");
+		PL_ASSERT_TRUE(tokenizer.first(" \t ").empty());
+		return true;
+	}
+
+	~Test_TokenizerViews() = default;
+};
+
+class Test_TokenizerFuzz : public Test
+{
+	static constexpr size_t ROUNDS = 20000;
+
+public:
+	Test_TokenizerFuzz() = default;
+
+	testdoc_t get_title() override { return "Test Tokenizer (Fuzz)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Split random lines of quotes, backslashes, whitespace and "
+			   "letters, comparing the words to reference_tokenize().";
+	}
+
+	bool run() override
+	{
+		const char alphabet[] = {'a', 'b', ' ', ' ', '\t', '"', '\'', '\\'};
+		unsigned long long int seed = 0x2545F4914F6CDD1DULL;
+		Cmd_tokenizer tokenizer;
+		std::string line;
+
+		auto next = [&seed]() {
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			return seed;
+		};
+
+		for (size_t round = 0; round < ROUNDS; ++round) {
+			line.clear();
+			for (size_t i = 0, length = next() % 24; i < length; ++i) {
+				line += alphabet[next() % sizeof(alphabet)];
+			}
+
+			const Cmd_tokenizer::tokens& words = tokenizer.split(line);
+			std::vector<std::string> expected = reference_tokenize(line);
+			PL_ASSERT_EQUAL(words.size(), expected.size());
+			for (size_t i = 0; i < words.size(); ++i) {
+				PL_ASSERT_EQUAL(std::string(words[i]), expected[i]);
+			}
+
+			if (!expected.empty()) {
+				PL_ASSERT_EQUAL(std::string(tokenizer.first(line)),
+								expected.front());
+			}
+		}
+		return true;
+	}
+
+	~Test_TokenizerFuzz() = default;
+};
+
+/** A batch of typical command lines for the tokenizer benchmarks, some
+ * with quoted and escaped arguments. */
+inline const std::vector<std::string>& bench_command_lines()
+{
+	static const std::vector<std::string> lines = [] {
+		const char* samples[] = {
+			"help",
+			"history git",
+			"load /usr/share/dict/words 4096 --verbose",
+			"say \"hello, world\" 'and goodbye'",
+			"grep \"a \\\"quoted\\\" phrase\" notes.txt",
+			"set name=value other=\"two words\" third='it\\'s'"};
+		std::vector<std::string> v(256);
+		for (size_t i = 0; i < v.size(); ++i) {
+			v[i] = samples[i % (sizeof(samples) / sizeof(samples[0]))];
+		}
+		return v;
+	}();
+	return lines;
+}
+
+class Bench_Tokenizer : public Test
+{
+public:
+	const std::vector<std::string>& lines = bench_command_lines();
+	Cmd_tokenizer tokenizer;
+	/// Accumulated so the work can't be optimized away.
+	size_t total = 0;
+
+	Bench_Tokenizer() = default;
+
+	testdoc_t get_title() override { return "Benchmark Cmd_tokenizer"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Split a batch of command lines with a reused Cmd_tokenizer.";
+	}
+
+	bool run() override
+	{
+		for (const std::string& line : lines) {
+			total += tokenizer.split(line).size();
+		}
+		return true;
+	}
+
+	~Bench_Tokenizer() = default;
+};
+
+class Bench_LegacyProcessOptions : public Test
+{
+public:
+	std::vector<std::string> lines = bench_command_lines();
+	size_t total = 0;
+
+	Bench_LegacyProcessOptions() = default;
+
+	testdoc_t get_title() override
+	{
+		return "Benchmark legacy process_options()";
+	}
+
+	testdoc_t get_docs() override
+	{
+		return "Split a batch of command lines with the old character-by-"
+			   "character process_options().";
+	}
+
+	bool run() override
+	{
+		for (std::string& line : lines) {
+			total += legacy_process_options(line).size();
+		}
+		return true;
+	}
+
+	~Bench_LegacyProcessOptions() = default;
+};
+
+class TestSuite_BlueshellTokenizer : public TestSuite
+{
+public:
+	explicit TestSuite_BlueshellTokenizer() = default;
+
+	void load_tests() override;
+
+	testdoc_t get_title() override { return "IOSqueak: Blueshell Tokenizer"; }
+
+	~TestSuite_BlueshellTokenizer() = default;
+};
+
+#endif  // IOSQUEAK_BLUESHELL_TOKENIZER_TESTS_HPP
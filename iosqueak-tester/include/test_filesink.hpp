@@ -0,0 +1,254 @@
+/** Tests for FileSink [IOSQueak]
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_FILESINK_TESTS_HPP
+#define IOSQUEAK_FILESINK_TESTS_HPP
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "goldilocks/assertions.hpp"
+#include "goldilocks/goldilocks.hpp"
+#include "iosqueak/channel.hpp"
+#include "iosqueak/filesink.hpp"
+
+/** Create a new temporary directory for a sink's files.
+ * \return the path of the directory, or an empty string on failure
+ */
+inline std::string make_sink_dir()
+{
+	char path[] = "/tmp/iosqueak-filesink-XXXXXX";
+	if (mkdtemp(path) == nullptr) {
+		return std::string();
+	}
+	return path;
+}
+
+/** Read a whole file.
+ * \return the contents, or "(missing)" if the file can't be opened
+ */
+inline std::string read_sink_file(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return "(missing)";
+	}
+	std::ostringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+class Test_FileSinkWrite : public Test
+{
+public:
+	Test_FileSinkWrite() = default;
+
+	testdoc_t get_title() override { return "Test FileSink (Write)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Write messages which are buffered, filtered, larger than the "
+			   "buffers, and sent through a channel, and check the file.";
+	}
+
+	bool run() override
+	{
+		std::string dir = make_sink_dir();
+		PL_ASSERT_TRUE(!dir.empty());
+		std::string path = dir + "/log";
+		bool ok = check(path);
+		std::filesystem::remove_all(dir);
+		return ok;
+	}
+
+	bool check(const std::string& path)
+	{
+		FileSink sink(path, IOVrb::normal, IOCat::all, 4096, 2);
+
+		// Small messages wait in the buffers until flushed...
+		sink.write("one\n", IOVrb::normal, IOCat::normal);
+		PL_ASSERT_EQUAL(read_sink_file(path), "");
+		sink.flush();
+		PL_ASSERT_EQUAL(read_sink_file(path), "one\n");
+
+		// ...filtered messages never arrive...
+		sink.write("chatter\n", IOVrb::tmi, IOCat::normal);
+		sink.flush();
+		PL_ASSERT_EQUAL(read_sink_file(path), "one\n");
+
+		// ...and a message larger than the buffers is written at once.
+		std::string big(3 * 4096, 'x');
+		sink.write("two\n", IOVrb::normal, IOCat::normal);
+		sink.write(big, IOVrb::normal, IOCat::normal);
+		PL_ASSERT_EQUAL(read_sink_file(path), "one\ntwo\n" + big);
+
+		/* Messages broadcast on a channel are written too. Without the
+		 * standard set to none, they would include ANSI codes. */
+		Channel chan;
+		chan.configure_echo(IOEchoMode::none);
+		sink.attach(chan);
+		chan << IOFormatStandard::none << "three" << IOCtrl::endl;
+		sink.detach();
+		chan << IOFormatStandard::none << "four" << IOCtrl::endl;
+		sink.flush();
+		PL_ASSERT_EQUAL(read_sink_file(path), "one\ntwo\n" + big + "three\n");
+
+		PL_ASSERT_EQUAL(sink.last_error(), 0);
+		return true;
+	}
+
+	~Test_FileSinkWrite() = default;
+};
+
+class Test_FileSinkRotate : public Test
+{
+public:
+	Test_FileSinkRotate() = default;
+
+	testdoc_t get_title() override { return "Test FileSink (Rotate)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Write past the rotation size several times, and check that "
+			   "each file holds whole messages and only two are kept.";
+	}
+
+	bool run() override
+	{
+		std::string dir = make_sink_dir();
+		PL_ASSERT_TRUE(!dir.empty());
+		std::string path = dir + "/log";
+		bool ok = check(path);
+		std::filesystem::remove_all(dir);
+		return ok;
+	}
+
+	bool check(const std::string& path)
+	{
+		{
+			FileSink sink(path);
+			sink.configure_rotation(32, std::chrono::seconds(0), 2);
+			sink.configure_delay(std::chrono::milliseconds(0));
+
+			// Three ten-byte messages fit in each file.
+			for (int i = 0; i < 10; ++i) {
+				std::string msg = "message " + std::to_string(i) + "\n";
+				sink.write(msg, IOVrb::normal, IOCat::normal);
+			}
+		}
+
+		PL_ASSERT_EQUAL(read_sink_file(path), "message 9\n");
+		PL_ASSERT_EQUAL(read_sink_file(path + ".1"),
+						"message 6\nmessage 7\nmessage 8\n");
+		PL_ASSERT_EQUAL(read_sink_file(path + ".2"),
+						"message 3\nmessage 4\nmessage 5\n");
+		PL_ASSERT_EQUAL(read_sink_file(path + ".3"), "(missing)");
+		return true;
+	}
+
+	~Test_FileSinkRotate() = default;
+};
+
+class Test_FileSinkReopen : public Test
+{
+public:
+	Test_FileSinkReopen() = default;
+
+	testdoc_t get_title() override { return "Test FileSink (Reopen)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Close a sink with buffered data, open a new one on the same "
+			   "file, and check that it appends and counts the existing size "
+			   "toward rotation.";
+	}
+
+	bool run() override
+	{
+		std::string dir = make_sink_dir();
+		PL_ASSERT_TRUE(!dir.empty());
+		std::string path = dir + "/log";
+		bool ok = check(path);
+		std::filesystem::remove_all(dir);
+		return ok;
+	}
+
+	bool check(const std::string& path)
+	{
+		{
+			// Closing the sink writes out what is still buffered.
+			FileSink sink(path);
+			sink.write("message 0\n", IOVrb::normal, IOCat::normal);
+			sink.write("message 1\n", IOVrb::normal, IOCat::normal);
+		}
+		PL_ASSERT_EQUAL(read_sink_file(path), "message 0\nmessage 1\n");
+
+		{
+			FileSink sink(path);
+			sink.configure_rotation(32, std::chrono::seconds(0), 2);
+			sink.write("message 2\n", IOVrb::normal, IOCat::normal);
+			sink.write("message 3\n", IOVrb::normal, IOCat::normal);
+		}
+		PL_ASSERT_EQUAL(read_sink_file(path + ".1"),
+						"message 0\nmessage 1\nmessage 2\n");
+		PL_ASSERT_EQUAL(read_sink_file(path), "message 3\n");
+		return true;
+	}
+
+	~Test_FileSinkReopen() = default;
+};
+
+class TestSuite_FileSink : public TestSuite
+{
+public:
+	explicit TestSuite_FileSink() = default;
+
+	void load_tests() override;
+
+	testdoc_t get_title() override { return "IOSqueak: FileSink"; }
+
+	~TestSuite_FileSink() = default;
+};
+
+#endif  // IOSQUEAK_FILESINK_TESTS_HPP
@@ -0,0 +1,196 @@
+/** Tests for Tools: HexDump [IOSQueak]
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_HEXDUMP_TESTS_HPP
+#define IOSQUEAK_HEXDUMP_TESTS_HPP
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "goldilocks/assertions.hpp"
+#include "goldilocks/goldilocks.hpp"
+#include "iosqueak/tools/hexdump.hpp"
+
+/** Dump a region into a single string.
+ * \return every row, each with its trailing newline
+ */
+inline std::string hexdump_string(const HexDump& hexdump,
+								  const void* data,
+								  size_t len)
+{
+	std::string str = std::string();
+	hexdump.dump(data, len, [&str](std::string_view row) { str += row; });
+	return str;
+}
+
+class Test_HexDumpRows : public Test
+{
+public:
+	Test_HexDumpRows() = default;
+
+	testdoc_t get_title() override { return "Test HexDump (Rows)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Compare full and partial rows, and a collapsed run of "
+			   "repeated rows, with the output of `hexdump -C`.";
+	}
+
+	bool run() override
+	{
+		HexDump hexdump;
+
+		// A full row, then a partial one, then the offset past the end.
+		std::string_view text("Hello, hexdump!\nABC");
+		PL_ASSERT_EQUAL(
+			hexdump_string(hexdump, text.data(), text.size()),
+			"00000000  48 65 6c 6c 6f 2c 20 68  65 78 64 75 6d 70 21 0a  "
+			"|Hello, hexdump!.|\n"
+			"00000010  41 42 43                                          "
+			"|ABC|\n"
+			"00000013\n");
+
+		// Identical rows after the first are collapsed to a '*'.
+		std::vector<uint8_t> zeros(64, 0);
+		zeros.push_back('x');
+		std::string collapsed =
+			"00000000  00 00 00 00 00 00 00 00  00 00 00 00 00 00 00 00  "
+			"|................|\n"
+			"*\n"
+			"00000040  78                                                "
+			"|x|\n"
+			"00000041\n";
+		PL_ASSERT_EQUAL(hexdump_string(hexdump, zeros.data(), zeros.size()),
+						collapsed);
+
+		// A partial row never counts as a repeat.
+		PL_ASSERT_EQUAL(hexdump_string(hexdump, zeros.data(), 20),
+						"00000000  00 00 00 00 00 00 00 00  00 00 00 00 00 00 "
+						"00 00  |................|\n"
+						"00000010  00 00 00 00                   "
+						"                    |....|\n"
+						"00000014\n");
+
+		// Without collapsing, every row is shown.
+		HexDump every(16, false);
+		std::string all = hexdump_string(every, zeros.data(), zeros.size());
+		PL_ASSERT_TRUE(all.find('*') == std::string::npos);
+		PL_ASSERT_TRUE(all.find("00000030  00") != std::string::npos);
+
+		// Nothing at all for an empty region.
+		PL_ASSERT_EQUAL(hexdump_string(hexdump, text.data(), 0), "");
+		return true;
+	}
+
+	~Test_HexDumpRows() = default;
+};
+
+class Test_HexDumpLayout : public Test
+{
+public:
+	Test_HexDumpLayout() = default;
+
+	testdoc_t get_title() override { return "Test HexDump (Layout)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Check 32-byte rows, uppercase digits, start_at(), and the "
+			   "wide offset column, including offsets near the top.";
+	}
+
+	bool run() override
+	{
+		std::string alphabet;
+		for (char ch = 'A'; ch <= '`'; ++ch) {
+			alphabet += ch;
+		}
+		PL_ASSERT_EQUAL(
+			hexdump_string(HexDump(32), alphabet.data(), alphabet.size()),
+			"00000000  41 42 43 44 45 46 47 48  49 4a 4b 4c 4d 4e 4f 50  "
+			"51 52 53 54 55 56 57 58  59 5a 5b 5c 5d 5e 5f 60  "
+			"|ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`|\n"
+			"00000020\n");
+
+		HexDump upper(16, true, IOFormatNumCase::upper);
+		std::string_view text("ABC\xFF");
+		PL_ASSERT_EQUAL(hexdump_string(upper.start_at(0xABC0),
+									   text.data(),
+									   text.size()),
+						"0000ABC0  41 42 43 FF                   "
+						"                    |ABC.|\n"
+						"0000ABC4\n");
+
+		// Offsets past 32 bits widen the column...
+		HexDump wide;
+		wide.start_at(0xFFFFFFF8);
+		std::string rows = hexdump_string(wide, alphabet.data(), 16);
+		PL_ASSERT_EQUAL(rows.substr(0, 18), "00000000fffffff8  ");
+		PL_ASSERT_EQUAL(rows.substr(rows.size() - 17), "0000000100000008\n");
+
+		// ...even when the end wraps around past the top.
+		std::string_view digits("0123456789abcdef");
+		wide.start_at(0xFFFFFFFFFFFFFFF0ULL);
+		PL_ASSERT_EQUAL(
+			hexdump_string(wide, digits.data(), digits.size()),
+			"fffffffffffffff0  30 31 32 33 34 35 36 37  38 39 61 62 63 64 65 "
+			"66  |0123456789abcdef|\n"
+			"0000000000000000\n");
+		return true;
+	}
+
+	~Test_HexDumpLayout() = default;
+};
+
+class TestSuite_HexDump : public TestSuite
+{
+public:
+	explicit TestSuite_HexDump() = default;
+
+	void load_tests() override;
+
+	testdoc_t get_title() override { return "IOSqueak: HexDump"; }
+
+	~TestSuite_HexDump() = default;
+};
+
+#endif  // IOSQUEAK_HEXDUMP_TESTS_HPP
@@ -0,0 +1,238 @@
+/** Tests for Blueshell: Line Renderer [IOSQueak]
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_BLUESHELL_LINERENDERER_TESTS_HPP
+#define IOSQUEAK_BLUESHELL_LINERENDERER_TESTS_HPP
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+#include "goldilocks/assertions.hpp"
+#include "goldilocks/goldilocks.hpp"
+#include "iosqueak/linerenderer.hpp"
+
+/** A model of a single terminal row, which understands just the output
+ * LineRenderer produces, so what it draws can be checked.
+ */
+class ScreenModel
+{
+public:
+	std::string row;
+	size_t column = 0;
+
+	/** Apply terminal output to the row.
+	 * \return false if the output contained anything unexpected
+	 */
+	bool feed(std::string_view out)
+	{
+		for (size_t i = 0; i < out.size(); ++i) {
+			char ch = out[i];
+			if (ch == '\r') {
+				column = 0;
+			} else if (ch == '\n') {
+				row.clear();
+				column = 0;
+			} else if (ch == '\x1b') {
+				if (++i >= out.size() || out[i] != '[') {
+					return false;
+				}
+				size_t n = 0;
+				bool has_n = false;
+				while (++i < out.size() && out[i] >= '0' && out[i] <= '9') {
+					n = n * 10 + static_cast<size_t>(out[i] - '0');
+					has_n = true;
+				}
+				if (i >= out.size()) {
+					return false;
+				}
+				switch (out[i]) {
+					case 'C':
+						column += has_n ? n : 1;
+						break;
+					case 'D':
+						if ((has_n ? n : 1) > column) {
+							return false;
+						}
+						column -= has_n ? n : 1;
+						break;
+					case 'K':
+						if (has_n && n == 2) {
+							row.clear();
+						} else if (column < row.size()) {
+							row.resize(column);
+						}
+						break;
+					case '@':
+						if (column < row.size()) {
+							row.insert(column, has_n ? n : 1, ' ');
+						}
+						break;
+					case 'P':
+						if (column < row.size()) {
+							row.erase(column, has_n ? n : 1);
+						}
+						break;
+					default:
+						return false;
+				}
+			} else {
+				if (column > row.size()) {
+					row.resize(column, ' ');
+				}
+				if (column == row.size()) {
+					row += ch;
+				} else {
+					row[column] = ch;
+				}
+				++column;
+			}
+		}
+		return true;
+	}
+};
+
+class Test_LineRendererModel : public Test
+{
+	static constexpr size_t ROUNDS = 20000;
+
+public:
+	Test_LineRendererModel() = default;
+
+	testdoc_t get_title() override { return "Test LineRenderer (Model)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Apply random edits and cursor moves to a line, drawing them "
+			   "onto a model terminal, and check that the row and cursor "
+			   "match the line after every flush().";
+	}
+
+	bool run() override
+	{
+		FILE* out = tmpfile();
+		PL_ASSERT_TRUE(out != nullptr);
+
+		const std::string prompt = "> ";
+		LineRenderer renderer(prompt, fileno(out));
+		ScreenModel screen;
+		std::string text;
+		size_t position = 0;
+		off_t read_to = 0;
+		unsigned long long int seed = 0x9E3779B97F4A7C15ULL;
+
+		auto next = [&seed]() {
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			return seed;
+		};
+
+		bool ok = true;
+		for (size_t round = 0; ok && round < ROUNDS; ++round) {
+			size_t at = (text.empty()) ? 0 : next() % (text.size() + 1);
+			switch (next() % 6) {
+				case 0:
+				case 1:
+					// Type a few characters.
+					text.insert(at, next() % 3 + 1, "abcxyz"[next() % 6]);
+					break;
+				case 2:
+					// Delete a few characters.
+					text.erase(at, next() % 3 + 1);
+					break;
+				case 3:
+					// Replace a character.
+					if (at < text.size()) {
+						text[at] = "ABC"[next() % 3];
+					}
+					break;
+				case 4:
+					// Replace the whole line, as history does.
+					text.assign(next() % 40, "lmn"[next() % 3]);
+					break;
+				case 5:
+					// Forget the screen, as after other output.
+					if (next() % 8 == 0) {
+						renderer.invalidate();
+					}
+					break;
+			}
+			position = next() % (text.size() + 1);
+			renderer.render(text, position);
+
+			// Several edits may be queued before each flush.
+			if (next() % 3 != 0) {
+				continue;
+			}
+			renderer.flush();
+
+			char buf[4096];
+			ssize_t got;
+			while ((got = pread(fileno(out), buf, sizeof(buf), read_to)) > 0) {
+				ok = ok && screen.feed(std::string_view(buf, got));
+				read_to += got;
+			}
+			ok = ok && screen.row == prompt + text &&
+				 screen.column == prompt.size() + position;
+		}
+		fclose(out);
+
+		PL_ASSERT_TRUE(ok);
+		return true;
+	}
+
+	~Test_LineRendererModel() = default;
+};
+
+class TestSuite_LineRenderer : public TestSuite
+{
+public:
+	explicit TestSuite_LineRenderer() = default;
+
+	void load_tests() override;
+
+	testdoc_t get_title() override { return "IOSqueak: Blueshell Line Renderer"; }
+
+	~TestSuite_LineRenderer() = default;
+};
+
+#endif  // IOSQUEAK_BLUESHELL_LINERENDERER_TESTS_HPP
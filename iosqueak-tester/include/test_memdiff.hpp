@@ -0,0 +1,363 @@
+/** Tests for Tools: MemDiff [IOSQueak]
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_MEMDIFF_TESTS_HPP
+#define IOSQUEAK_MEMDIFF_TESTS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "goldilocks/assertions.hpp"
+#include "goldilocks/goldilocks.hpp"
+#include "iosqueak/tools/memdiff.hpp"
+#include "iosqueak/tools/memlens.hpp"
+
+/** A byte-at-a-time version of MemDiff::compare(), which it is checked
+ * against, and which serves as the benchmark baseline.
+ */
+inline void reference_compare(MemSpan lhs,
+							  MemSpan rhs,
+							  std::vector<MemDiff::Range>& out)
+{
+	out.clear();
+	size_t total = (lhs.size() > rhs.size()) ? lhs.size() : rhs.size();
+	for (size_t i = 0; i < total; ++i) {
+		bool differs =
+			i >= lhs.size() || i >= rhs.size() || lhs[i] != rhs[i];
+		if (!differs) {
+			continue;
+		}
+		if (!out.empty() && out.back().offset + out.back().length == i) {
+			++out.back().length;
+		} else {
+			out.push_back(MemDiff::Range{i, 1});
+		}
+	}
+}
+
+class Test_MemDiffCompare : public Test
+{
+	static constexpr size_t ROUNDS = 2000;
+
+public:
+	Test_MemDiffCompare() = default;
+
+	testdoc_t get_title() override { return "Test MemDiff::compare()"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Compare random regions with scattered and clustered changes, "
+			   "and of different lengths, against reference_compare().";
+	}
+
+	bool run() override
+	{
+		unsigned long long int seed = 0x2545F4914F6CDD1DULL;
+		auto next = [&seed]() {
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			return seed;
+		};
+
+		std::vector<uint8_t> lhs;
+		std::vector<uint8_t> rhs;
+		std::vector<MemDiff::Range> ranges;
+		std::vector<MemDiff::Range> expected;
+
+		for (size_t round = 0; round < ROUNDS; ++round) {
+			lhs.resize(next() % 200);
+			for (uint8_t& byte : lhs) {
+				byte = static_cast<uint8_t>(next());
+			}
+			rhs = lhs;
+			// Sometimes a length change, and a few runs of changes.
+			if (next() % 4 == 0) {
+				rhs.resize(next() % 200, 0xAA);
+			}
+			for (size_t runs = next() % 4; runs > 0 && !rhs.empty(); --runs) {
+				size_t at = next() % rhs.size();
+				for (size_t n = next() % 40; n > 0 && at < rhs.size(); --n) {
+					rhs[at++] ^= static_cast<uint8_t>(next() % 255 + 1);
+				}
+			}
+
+			MemDiff::compare(MemSpan(lhs), MemSpan(rhs), ranges);
+			reference_compare(MemSpan(lhs), MemSpan(rhs), expected);
+			PL_ASSERT_EQUAL(ranges.size(), expected.size());
+			for (size_t i = 0; i < ranges.size(); ++i) {
+				PL_ASSERT_EQUAL(ranges[i].offset, expected[i].offset);
+				PL_ASSERT_EQUAL(ranges[i].length, expected[i].length);
+			}
+		}
+		return true;
+	}
+
+	~Test_MemDiffCompare() = default;
+};
+
+class Test_MemDiffDump : public Test
+{
+public:
+	Test_MemDiffDump() = default;
+
+	testdoc_t get_title() override { return "Test MemDiff::dump()"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Change bytes in a watched region, and check that only the "
+			   "changed rows are dumped, before and after, with the changed "
+			   "bytes highlighted.";
+	}
+
+	bool run() override
+	{
+		uint8_t region[48] = {0};
+		MemLens lens(region, IOMemReadSize(sizeof(region)));
+		MemDiff diff(lens);
+
+		region[17] = 'A';
+		region[18] = 'B';
+		PL_ASSERT_TRUE(diff.update().size() == 1);
+		PL_ASSERT_EQUAL(diff.changes()[0].offset, 17u);
+		PL_ASSERT_EQUAL(diff.changes()[0].length, 2u);
+
+		std::string plain;
+		diff.dump([&plain](std::string_view line) { plain.append(line); },
+				  IOFormatStandard::none);
+		PL_ASSERT_EQUAL(plain,
+						"-00000010  00 00 00 00 00 00 00 00  00 00 00 00"
+						" 00 00 00 00  |................|\n"
+						"+00000010  00 41 42 00 00 00 00 00  00 00 00 00"
+						" 00 00 00 00  |.AB.............|\n");
+
+		// With highlighting, each changed byte is wrapped in the color.
+		std::string colored;
+		diff.dump([&colored](std::string_view line) { colored.append(line); });
+		PL_ASSERT_TRUE(colored.find("31m41\x1b[39m") != std::string::npos);
+		PL_ASSERT_TRUE(colored.find("31mA\x1b[39m") != std::string::npos);
+
+		// Nothing changed since, so nothing is dumped.
+		PL_ASSERT_TRUE(diff.update().empty());
+		plain.clear();
+		diff.dump([&plain](std::string_view line) { plain.append(line); });
+		PL_ASSERT_TRUE(plain.empty());
+		return true;
+	}
+
+	~Test_MemDiffDump() = default;
+};
+
+class Test_MemDiffDumpChannel : public Test
+{
+public:
+	Test_MemDiffDumpChannel() = default;
+
+	testdoc_t get_title() override { return "Test MemDiff::dump() (Channel)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Dump changes to a channel, and check that the highlighting "
+			   "follows the channel's formatting standard and returns to the "
+			   "message's own color.";
+	}
+
+	bool run() override
+	{
+		uint8_t region[16] = {0};
+		MemLens lens(region, IOMemReadSize(sizeof(region)));
+		MemDiff diff(lens);
+		region[1] = 'A';
+		diff.update();
+
+		Channel chan;
+		chan.configure_echo(IOEchoMode::none);
+		std::vector<std::string> messages;
+		chan.signal_all.append(
+			[&messages](std::string msg) { messages.push_back(msg); });
+
+		// Without a standard, there is nothing but the text.
+		chan << IOFormatStandard::none << IOFormatTextFG::green;
+		diff.dump(chan);
+		PL_ASSERT_EQUAL(messages.size(), 2u);
+		PL_ASSERT_EQUAL(messages[1],
+						"+00000000  00 41 00 00 00 00 00 00  00 00 00 00 00 00 "
+						"00 00  |.A..............|\n");
+		chan << IOCtrl::end;
+
+		// With ANSI, the changed bytes return to green, not the default.
+		messages.clear();
+		chan << IOFormatStandard::ansi << IOFormatTextFG::green;
+		diff.dump(chan);
+		PL_ASSERT_EQUAL(messages.size(), 2u);
+		PL_ASSERT_TRUE(messages[1].find("31m41\x1b[32m") != std::string::npos);
+		PL_ASSERT_TRUE(messages[1].find("31mA\x1b[32m") != std::string::npos);
+		PL_ASSERT_TRUE(messages[1].find("\x1b[39m") == std::string::npos);
+		chan << IOCtrl::end;
+		return true;
+	}
+
+	~Test_MemDiffDumpChannel() = default;
+};
+
+class Test_MemDiffLens : public Test
+{
+public:
+	Test_MemDiffLens() = default;
+
+	testdoc_t get_title() override { return "Test MemDiff (Lens Ownership)"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Watch shared regions through lenses that do and don't hold "
+			   "them, and check that only held regions are read.";
+	}
+
+	bool run() override
+	{
+		auto value = std::make_shared<uint32_t>(1);
+
+		// A snapshot lens doesn't hold the region, so has nothing live.
+		MemLens frozen(value, LensMode::snapshot);
+		PL_ASSERT_TRUE(frozen.live().empty());
+		PL_ASSERT_EQUAL(frozen.view().size(), sizeof(uint32_t));
+
+		// A DynamicMemLens holds it only while reading.
+		DynamicMemLens<uint32_t> dynamic(value);
+		MemDiff diff(dynamic);
+		PL_ASSERT_EQUAL(diff.current().size(), sizeof(uint32_t));
+		*value = 2;
+		PL_ASSERT_TRUE(diff.changed() == false);
+		PL_ASSERT_TRUE(!diff.update().empty());
+
+		// Once the region is gone, it reads as empty.
+		value.reset();
+		diff.update();
+		PL_ASSERT_TRUE(diff.current().empty());
+		return true;
+	}
+
+	~Test_MemDiffLens() = default;
+};
+
+/** The region for the MemDiff benchmarks: 64 KiB, with a few bytes
+ * changed between snapshots, as when watching a large structure. */
+class Bench_MemDiffUpdate : public Test
+{
+public:
+	std::vector<uint8_t> region = std::vector<uint8_t>(64 * 1024, 0);
+	MemLens lens = MemLens(region.data(), IOMemReadSize(region.size()));
+	MemDiff diff = MemDiff(lens);
+	size_t round = 0;
+
+	Bench_MemDiffUpdate() = default;
+
+	testdoc_t get_title() override { return "Benchmark MemDiff::update()"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Snapshot and compare a 64 KiB region with a few changed "
+			   "bytes.";
+	}
+
+	bool run() override
+	{
+		++round;
+		region[(round * 4099) % region.size()] ^= 1;
+		region[(round * 127) % region.size()] ^= 1;
+		diff.update();
+		return true;
+	}
+
+	~Bench_MemDiffUpdate() = default;
+};
+
+class Bench_MemDiffUpdateBytewise : public Test
+{
+public:
+	std::vector<uint8_t> region = std::vector<uint8_t>(64 * 1024, 0);
+	std::vector<uint8_t> before;
+	std::vector<uint8_t> after = region;
+	std::vector<MemDiff::Range> ranges;
+	size_t round = 0;
+
+	Bench_MemDiffUpdateBytewise() = default;
+
+	testdoc_t get_title() override
+	{
+		return "Benchmark byte-at-a-time update";
+	}
+
+	testdoc_t get_docs() override
+	{
+		return "Snapshot a 64 KiB region with a few changed bytes, and "
+			   "compare it with reference_compare().";
+	}
+
+	bool run() override
+	{
+		++round;
+		region[(round * 4099) % region.size()] ^= 1;
+		region[(round * 127) % region.size()] ^= 1;
+		before.swap(after);
+		after.assign(region.begin(), region.end());
+		reference_compare(MemSpan(before), MemSpan(after), ranges);
+		return true;
+	}
+
+	~Bench_MemDiffUpdateBytewise() = default;
+};
+
+class TestSuite_MemDiff : public TestSuite
+{
+public:
+	explicit TestSuite_MemDiff() = default;
+
+	void load_tests() override;
+
+	testdoc_t get_title() override { return "IOSqueak: MemDiff"; }
+
+	~TestSuite_MemDiff() = default;
+};
+
+#endif  // IOSQUEAK_MEMDIFF_TESTS_HPP
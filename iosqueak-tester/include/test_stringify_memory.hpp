@@ -0,0 +1,223 @@
+/** Tests for Stringify: Memory [IOSQueak]
+ *
+ * Author(s): Jason C. McDonald
+ */
+
+/* LICENSE (BSD-3-Clause)
+ * Copyright (c) 2020 MousePaw Media.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ * may be used to endorse or promote products derived from this software without
+ * specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * CONTRIBUTING
+ * See https://www.mousepawmedia.com/developers for information
+ * on how to contribute to our projects.
+ */
+
+#ifndef IOSQUEAK_STRINGIFY_MEMORY_TESTS_HPP
+#define IOSQUEAK_STRINGIFY_MEMORY_TESTS_HPP
+
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "goldilocks/assertions.hpp"
+#include "goldilocks/goldilocks.hpp"
+#include "iosqueak/stringify/memory.hpp"
+
+/** A byte-at-a-time memory dump, built from std::to_chars(), which
+ * _stringify_memory_to() and everything using it are checked against.
+ * Bytes are written from last to first, each as zero-padded digits with
+ * the most significant first. */
+inline std::string reference_stringify_memory(const uint8_t* data,
+											  size_t len,
+											  IOFormatMemSep sep,
+											  IOFormatBase base,
+											  IOFormatNumCase num_case)
+{
+	const int radix = static_cast<int>(base);
+	const size_t width = (radix == 2) ? 8 : (radix == 8) ? 4 : 2;
+	const bool byte_sep = flags_check(sep, IOFormatMemSep::byte);
+	const bool word_sep = flags_check(sep, IOFormatMemSep::word);
+
+	std::string str = std::string();
+	for (size_t done = 1; done <= len; ++done) {
+		char digits[8];
+		char* end = std::to_chars(digits, digits + 8, data[len - done], radix)
+						.ptr;
+		str.append(width - static_cast<size_t>(end - digits), '0');
+		for (char* ch = digits; ch < end; ++ch) {
+			str += (num_case == IOFormatNumCase::upper)
+					   ? static_cast<char>(std::toupper(*ch))
+					   : *ch;
+		}
+		if (byte_sep) {
+			str += ' ';
+		}
+		if (word_sep && done % 8 == 0) {
+			str += byte_sep ? "| " : "|";
+		}
+	}
+	return str;
+}
+
+class Test_StringifyByte : public Test
+{
+public:
+	Test_StringifyByte() = default;
+
+	testdoc_t get_title() override { return "Test Stringify Byte"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Check the digit order of stringify_byte() in every base, "
+			   "then every byte against reference_stringify_memory().";
+	}
+
+	bool run() override
+	{
+		// The most significant digit comes first, in every base.
+		PL_ASSERT_EQUAL(stringify_byte(0x5A), "5A");
+		PL_ASSERT_EQUAL(
+			stringify_byte(0x5A, IOFormatBase::hex, IOFormatNumCase::lower),
+			"5a");
+		PL_ASSERT_EQUAL(stringify_byte(0x5A, IOFormatBase::oct), "0132");
+		PL_ASSERT_EQUAL(stringify_byte(0x5A, IOFormatBase::bin), "01011010");
+		PL_ASSERT_EQUAL(stringify_byte(0x01, IOFormatBase::bin), "00000001");
+
+		const IOFormatBase bases[] = {IOFormatBase::bin,
+									  IOFormatBase::oct,
+									  IOFormatBase::hex};
+		for (IOFormatBase base : bases) {
+			for (unsigned int value = 0; value < 256; ++value) {
+				uint8_t byte = static_cast<uint8_t>(value);
+				PL_ASSERT_EQUAL(
+					stringify_byte(byte, base, IOFormatNumCase::lower),
+					reference_stringify_memory(&byte,
+											   1,
+											   IOFormatMemSep::none,
+											   base,
+											   IOFormatNumCase::lower));
+			}
+		}
+		return true;
+	}
+
+	~Test_StringifyByte() = default;
+};
+
+class Test_StringifyBytes : public Test
+{
+public:
+	Test_StringifyBytes() = default;
+
+	testdoc_t get_title() override { return "Test Stringify Bytes"; }
+
+	testdoc_t get_docs() override
+	{
+		return "Compare stringify_bytes() of spans and integers against "
+			   "reference_stringify_memory(), for every separator, base and "
+			   "case, and lengths around the 64-byte blocks.";
+	}
+
+	bool run() override
+	{
+		const IOFormatMemSep seps[] = {IOFormatMemSep::none,
+									   IOFormatMemSep::byte,
+									   IOFormatMemSep::word,
+									   IOFormatMemSep::all};
+		const IOFormatBase bases[] = {IOFormatBase::bin,
+									  IOFormatBase::oct,
+									  IOFormatBase::hex};
+		const IOFormatNumCase cases[] = {IOFormatNumCase::lower,
+										 IOFormatNumCase::upper};
+
+		std::vector<uint8_t> data(200);
+		unsigned long long int seed = 0x9E3779B97F4A7C15ULL;
+		for (uint8_t& byte : data) {
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			byte = static_cast<uint8_t>(seed);
+		}
+
+		// An integer is dumped from its most significant byte.
+		const uint64_t number = 0x0123456789ABCDEFULL;
+		uint8_t number_bytes[8];
+		for (size_t i = 0; i < 8; ++i) {
+			number_bytes[i] = static_cast<uint8_t>(number >> (8 * i));
+		}
+
+		const size_t lengths[] = {0, 1, 7, 8, 9, 63, 64, 65, 128, 200};
+		for (IOFormatMemSep sep : seps) {
+			for (IOFormatBase base : bases) {
+				for (IOFormatNumCase num_case : cases) {
+					for (size_t len : lengths) {
+						std::string expected = reference_stringify_memory(
+							data.data(), len, sep, base, num_case);
+						PL_ASSERT_EQUAL(
+							stringify_bytes(MemSpan(data.data(), len),
+											sep,
+											base,
+											num_case),
+							expected);
+						PL_ASSERT_EQUAL(lengthify_memory(len, sep, base),
+										expected.length());
+					}
+
+					PL_ASSERT_EQUAL(
+						stringify_bytes(number, sep, base, num_case),
+						reference_stringify_memory(
+							number_bytes, 8, sep, base, num_case));
+				}
+			}
+		}
+
+		PL_ASSERT_EQUAL(stringify_bytes(number, IOFormatMemSep::all),
+						"01 23 45 67 89 AB CD EF | ");
+		return true;
+	}
+
+	~Test_StringifyBytes() = default;
+};
+
+class TestSuite_StringifyMemory : public TestSuite
+{
+public:
+	explicit TestSuite_StringifyMemory() = default;
+
+	void load_tests() override;
+
+	testdoc_t get_title() override { return "IOSqueak: Stringify Memory"; }
+
+	~TestSuite_StringifyMemory() = default;
+};
+
+#endif  // IOSQUEAK_STRINGIFY_MEMORY_TESTS_HPP
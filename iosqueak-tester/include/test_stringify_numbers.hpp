@@ -41,7 +41,15 @@
 #ifndef IOSQUEAK_STRINGIFY_NUMBERS_TESTS_HPP
 #define IOSQUEAK_STRINGIFY_NUMBERS_TESTS_HPP
 
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
 #include "iosqueak/stringify/numbers.hpp"
+#include "iosqueak/stringify/utilities.hpp"
 #include "goldilocks/goldilocks.hpp"
 #include "goldilocks/assertions.hpp"
 
@@ -49,10 +57,10 @@ class Test_LengthifyIntegral : public Test
 {
 public:
 	const int target = 424200;
-	const int pos_dec_len = 6;
-	const int neg_dec_len = 7;
-	const int pos_bin_len = 19;
-	const int pos_hex_len = 5;
+	const size_t pos_dec_len = 6;
+	const size_t neg_dec_len = 7;
+	const size_t pos_bin_len = 19;
+	const size_t pos_hex_len = 5;
 
 	Test_LengthifyIntegral() = default;
 
@@ -63,24 +71,30 @@ public:
 	bool run() override
 	{
 		// test length of positive number
-		PL_ASSERT_EQUAL(lengthify_integral(target), pos_doc_len);
+		PL_ASSERT_EQUAL(lengthify_integral(target), pos_dec_len);
 
 		// test length of negative number
-		PL_ASSERT_EQUAL(lengthify_integral(-target), neg_doc_len);
+		PL_ASSERT_EQUAL(lengthify_integral(-target), neg_dec_len);
 
 		// test sign always
 		PL_ASSERT_EQUAL(lengthify_integral(target,
 										   IOFormatBase::dec,
 										   IOFormatSign::always,
 										   IOFormatBaseNotation::prefix),
-						pos_doc_len + 1);
+						pos_dec_len + 1);
 
 		// test hexadecimal length
-		PL_ASSERT_EQUAL(lengthify_integral(target, IOFormatBase::hex),
+		PL_ASSERT_EQUAL(lengthify_integral(target,
+										   IOFormatBase::hex,
+										   IOFormatSign::automatic,
+										   IOFormatBaseNotation::none),
 						pos_hex_len);
 
 		// test binary length
-		PL_ASSERT_EQUAL(lengthify_integral(target, IOFormatBase::bin),
+		PL_ASSERT_EQUAL(lengthify_integral(target,
+										   IOFormatBase::bin,
+										   IOFormatSign::automatic,
+										   IOFormatBaseNotation::none),
 						pos_bin_len);
 
 		// test prefix on hexadecimal
@@ -96,19 +110,431 @@ public:
 										   IOFormatSign::automatic,
 										   IOFormatBaseNotation::subscript),
 						pos_bin_len + 2);
+
+		return true;
 	}
 
 	~Test_LengthifyIntegral() = default;
+};
+
+class Test_StringifyFloatingPointShortest : public Test
+{
+public:
+	const IOFormatDecimalPlaces shortest =
+		IOFormatDecimalPlaces(IOFormatDecimalPlaces::shortest);
+
+	Test_StringifyFloatingPointShortest() = default;
+
+	testdoc_t get_title() { return "Test Stringify Floating Point (Shortest)"; }
+
+	testdoc_t get_docs()
+	{
+		return "Test the shortest round-trip mode of "
+			   "stringify_floating_point(), including signed zero.";
+	}
+
+	bool run() override
+	{
+		// test digits which need no rounding
+		PL_ASSERT_EQUAL(stringify_floating_point(0.1, shortest), "0.1");
+		PL_ASSERT_EQUAL(stringify_floating_point(-2.5, shortest), "-2.5");
+		PL_ASSERT_EQUAL(stringify_floating_point(1200.0, shortest), "1200.0");
+
+		// test zero and negative zero
+		PL_ASSERT_EQUAL(stringify_floating_point(0.0, shortest), "0.0");
+		PL_ASSERT_EQUAL(stringify_floating_point(-0.0, shortest), "-0.0");
+		PL_ASSERT_EQUAL(stringify_floating_point(-0.0,
+												 shortest,
+												 IOFormatSciNotation::always),
+						"-0.0e+0");
+
+		// test scientific notation
+		PL_ASSERT_EQUAL(stringify_floating_point(1.5e-7, shortest),
+						"1.5e-7");
+
+		return true;
+	}
+
+	~Test_StringifyFloatingPointShortest() = default;
+};
+
+class Test_LengthifyFloatingPoint : public Test
+{
+public:
+	Test_LengthifyFloatingPoint() = default;
+
+	testdoc_t get_title() { return "Test Lengthify Floating Point"; }
+
+	testdoc_t get_docs()
+	{
+		return "Test that lengthify_floating_point() never counts fewer "
+			   "characters than stringify_floating_point() writes.";
+	}
+
+	bool run() override
+	{
+		const double values[] = {0.0,
+								 -0.0,
+								 0.5,
+								 0.1,
+								 123.456,
+								 -0.0012345,
+								 0.0012345678901234567,
+								 1.2345678901234567e-7,
+								 1.2345678901234567e-298,
+								 9.99999e-6,
+								 1e-12,
+								 4.9e-324,
+								 999999999999.9,
+								 1e15,
+								 1e300,
+								 -1.7976931348623157e308};
+		const IOFormatDecimalPlaces places[] = {
+			IOFormatDecimalPlaces(IOFormatDecimalPlaces::shortest),
+			IOFormatDecimalPlaces(0),
+			IOFormatDecimalPlaces(3),
+			IOFormatDecimalPlaces(14)};
+		const IOFormatSciNotation notations[] = {
+			IOFormatSciNotation::never,
+			IOFormatSciNotation::automatic,
+			IOFormatSciNotation::always};
+
+		for (double val : values) {
+			for (const IOFormatDecimalPlaces& place : places) {
+				for (const IOFormatSciNotation& sci : notations) {
+					PL_ASSERT_TRUE(
+						lengthify_floating_point(val, place, sci) >=
+						stringify_floating_point(val, place, sci).length());
+				}
+			}
+		}
+
+		return true;
+	}
+
+	~Test_LengthifyFloatingPoint() = default;
+};
+
+/** Build the expected output of stringify_integral() from std::to_chars(),
+ * adding the sign, case and base notation by hand. */
+template<typename T>
+std::string reference_stringify_integral(const T& val,
+										 unsigned int base,
+										 const IOFormatSign& sign,
+										 const IOFormatNumCase& num_case,
+										 const IOFormatBaseNotation& notation)
+{
+	if (val == 0) {
+		return "0";
+	}
+
+	char buf[sizeof(T) * 8 + 1];
+	std::to_chars_result res =
+		std::to_chars(buf, buf + sizeof(buf), val, static_cast<int>(base));
+	std::string digits(buf, res.ptr);
+
+	std::string str = std::string();
+	if (digits[0] == '-') {
+		str += '-';
+		digits.erase(0, 1);
+	} else if (sign == IOFormatSign::always) {
+		str += '+';
+	}
+
+	if (num_case == IOFormatNumCase::upper) {
+		for (char& ch : digits) {
+			ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+		}
+	}
+
+	if (base == 10 || notation == IOFormatBaseNotation::none) {
+		return str + digits;
+	}
+
+	if (notation == IOFormatBaseNotation::prefix) {
+		switch (base) {
+			case 2:
+				return str + "0b" + digits;
+			case 3:
+				return str + "0t" + digits;
+			case 8:
+				return str + "0o" + digits;
+			case 12:
+				return str + "0z" + digits;
+			case 16:
+				return str + "0x" + digits;
+		}
+	}
+
+	return str + digits + "_" + std::to_string(base);
 }
 
+class Test_StringifyIntegralToChars : public Test
+{
+public:
+	Test_StringifyIntegralToChars() = default;
+
+	testdoc_t get_title() { return "Test Stringify Integral (to_chars)"; }
+
+	testdoc_t get_docs()
+	{
+		return "Compare stringify_integral() and lengthify_integral() against "
+			   "std::to_chars() for every base, sign, case and notation, "
+			   "including the limits of each integer width.";
+	}
+
+	template<typename T>
+	bool check(const T& val)
+	{
+		const IOFormatSign signs[] = {IOFormatSign::automatic,
+									  IOFormatSign::always};
+		const IOFormatNumCase cases[] = {IOFormatNumCase::lower,
+										 IOFormatNumCase::upper};
+		const IOFormatBaseNotation notations[] = {
+			IOFormatBaseNotation::prefix,
+			IOFormatBaseNotation::subscript,
+			IOFormatBaseNotation::none};
+
+		for (unsigned int base = 2; base <= 36; ++base) {
+			IOFormatBase fmt_base = static_cast<IOFormatBase>(base);
+			for (const IOFormatSign& sign : signs) {
+				for (const IOFormatNumCase& num_case : cases) {
+					for (const IOFormatBaseNotation& notation : notations) {
+						std::string expected = reference_stringify_integral(
+							val, base, sign, num_case, notation);
+						PL_ASSERT_EQUAL(
+							stringify_integral(
+								val, fmt_base, sign, num_case, notation),
+							expected);
+						PL_ASSERT_EQUAL(
+							lengthify_integral(val, fmt_base, sign, notation),
+							expected.length());
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	bool run() override
+	{
+		// test zero, small values, and values around each base
+		for (int64_t val : {0, 1, -1, 2, -2, 7, 35, 36, -36, 424200, -424200}) {
+			PL_ASSERT_TRUE(check(val));
+		}
+
+		// test the limits of every width
+		PL_ASSERT_TRUE(check(std::numeric_limits<int64_t>::min()));
+		PL_ASSERT_TRUE(check(std::numeric_limits<int64_t>::max()));
+		PL_ASSERT_TRUE(check(std::numeric_limits<uint64_t>::max()));
+		PL_ASSERT_TRUE(check(std::numeric_limits<int32_t>::min()));
+		PL_ASSERT_TRUE(check(std::numeric_limits<uint32_t>::max()));
+		PL_ASSERT_TRUE(check(std::numeric_limits<int16_t>::min()));
+		PL_ASSERT_TRUE(check(std::numeric_limits<int8_t>::min()));
+		PL_ASSERT_TRUE(check(std::numeric_limits<uint8_t>::max()));
+
+		return true;
+	}
+
+	~Test_StringifyIntegralToChars() = default;
+};
+
+/** The stringify_integral() implementation prior to the lookup-table
+ * engine, kept only as a benchmark baseline. Supports bases 2-36.
+ */
+template<typename T>
+std::string legacy_stringify_integral(const T& val, unsigned int base)
+{
+	if (val == 0) {
+		return "0";
+	}
+
+	std::string str = std::string();
+	str.reserve(lengthify_integral(val, static_cast<IOFormatBase>(base)));
+
+	T number = (val >= 0) ? val : -val;
+	while (number) {
+		str += DIGIT_CHARS_UPPER[number % base];
+		number /= base;
+	}
+
+	if (base == 16) {
+		str += "x0";
+	}
+
+	if (val < 0) {
+		str += "-";
+	}
+
+	return reversify(str);
+}
+
+/** A fixed spread of small and large, positive and negative values for the
+ * integer formatting benchmarks, so every digit count is exercised. */
+inline const std::vector<long long int>& bench_integers()
+{
+	static const std::vector<long long int> values = [] {
+		std::vector<long long int> v(1024);
+		unsigned long long int seed = 0x9E3779B97F4A7C15ULL;
+		for (size_t i = 0; i < v.size(); ++i) {
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			v[i] = static_cast<long long int>(seed >> (i % 63 + 1));
+			if (i % 3 == 0) {
+				v[i] = -v[i];
+			}
+		}
+		return v;
+	}();
+	return values;
+}
+
+class Bench_StringifyIntegral : public Test
+{
+public:
+	const std::vector<long long int>& values = bench_integers();
+	IOFormatBase base;
+	/// Accumulated so the work can't be optimized away.
+	size_t total = 0;
+
+	explicit Bench_StringifyIntegral(IOFormatBase base) : base(base) {}
+
+	testdoc_t get_title() override
+	{
+		return "Benchmark stringify_integral() (base " +
+			   stringify_integral(static_cast<int>(base)) + ")";
+	}
+
+	testdoc_t get_docs() override
+	{
+		return "Format a spread of integers with stringify_integral().";
+	}
+
+	bool run() override
+	{
+		for (long long int value : values) {
+			total += stringify_integral(value, base).length();
+		}
+		return true;
+	}
+
+	~Bench_StringifyIntegral() = default;
+};
+
+class Bench_StringifyIntegralTo : public Test
+{
+public:
+	const std::vector<long long int>& values = bench_integers();
+	IOFormatBase base;
+	std::string buffer;
+	size_t total = 0;
+
+	explicit Bench_StringifyIntegralTo(IOFormatBase base) : base(base) {}
+
+	testdoc_t get_title() override
+	{
+		return "Benchmark stringify_integral_to() (base " +
+			   stringify_integral(static_cast<int>(base)) + ")";
+	}
+
+	testdoc_t get_docs() override
+	{
+		return "Format a spread of integers into a reused buffer with "
+			   "stringify_integral_to().";
+	}
+
+	bool run() override
+	{
+		for (long long int value : values) {
+			buffer.clear();
+			stringify_integral_to(buffer, value, base);
+			total += buffer.length();
+		}
+		return true;
+	}
+
+	~Bench_StringifyIntegralTo() = default;
+};
+
+class Bench_LegacyStringifyIntegral : public Test
+{
+public:
+	const std::vector<long long int>& values = bench_integers();
+	unsigned int base;
+	size_t total = 0;
+
+	explicit Bench_LegacyStringifyIntegral(unsigned int base) : base(base) {}
+
+	testdoc_t get_title() override
+	{
+		return "Benchmark legacy stringify_integral() (base " +
+			   stringify_integral(base) + ")";
+	}
+
+	testdoc_t get_docs() override
+	{
+		return "Format a spread of integers with the old divide-and-reverse "
+			   "stringify_integral().";
+	}
+
+	bool run() override
+	{
+		for (long long int value : values) {
+			total += legacy_stringify_integral(value, base).length();
+		}
+		return true;
+	}
+
+	~Bench_LegacyStringifyIntegral() = default;
+};
+
+class Bench_ToChars : public Test
+{
+public:
+	const std::vector<long long int>& values = bench_integers();
+	int base;
+	std::string buffer;
+	size_t total = 0;
+
+	explicit Bench_ToChars(int base) : base(base) {}
+
+	testdoc_t get_title() override
+	{
+		return "Benchmark std::to_chars() (base " + stringify_integral(base) +
+			   ")";
+	}
+
+	testdoc_t get_docs() override
+	{
+		return "Format a spread of integers into a reused buffer with "
+			   "std::to_chars(), for comparison.";
+	}
+
+	bool run() override
+	{
+		char str[72];
+		for (long long int value : values) {
+			auto result = std::to_chars(str, str + sizeof(str), value, base);
+			buffer.assign(str, result.ptr);
+			total += buffer.length();
+		}
+		return true;
+	}
+
+	~Bench_ToChars() = default;
+};
+
 class TestSuite_StringifyNumbers : public TestSuite
 {
 public:
-	explicit TestSuite_FlexArray() = default;
+	explicit TestSuite_StringifyNumbers() = default;
 
-	void load_test() override;
+	void load_tests() override;
 
 	testdoc_t get_title() override { return "IOSqueak: Stringify Numbers"; }
 
-	~TestSuite_FLexArray() = default;
-}
+	~TestSuite_StringifyNumbers() = default;
+};
+
+#endif  // IOSQUEAK_STRINGIFY_NUMBERS_TESTS_HPP
@@ -45,7 +45,7 @@
 #include <limits>
 #include <string>
 
-// #include "goldilocks/shell.hpp"
+#include "goldilocks/shell.hpp"
 #include "iosqueak/blueshell.hpp"
 #include "iosqueak/channel.hpp"
 #include "iosqueak/stringify.hpp"
@@ -53,7 +53,16 @@
 #include "iosqueak/tools/memlens.hpp"
 // #include "goldilocks/coordinator.hpp"
 
-// #include "test_stringify_numbers.hpp"
+#include "test_blueshell_args.hpp"
+#include "test_blueshell_history.hpp"
+#include "test_blueshell_jobs.hpp"
+#include "test_blueshell_tokenizer.hpp"
+#include "test_filesink.hpp"
+#include "test_hexdump.hpp"
+#include "test_linerenderer.hpp"
+#include "test_memdiff.hpp"
+#include "test_stringify_memory.hpp"
+#include "test_stringify_numbers.hpp"
 
 void dummy_func(int, int, bool) { return; }
 
@@ -67,37 +76,40 @@ void test_code() { TestRegister shell; }
 
 int main(int argc, char* argv[])
 {
-	(void)argc;
-	(void)argv;
 	// Return code.
 	int r = 0;
 
-	test_code();
-
 	// Set up signal handling.
-	// ioc.configure_echo(IOEchoMode::cout);
-
-	// GoldilocksShell* shell = new GoldilocksShell(">> ");
-	// shell->register_suite<TestSuite_CoreTypes>("I-sB13");
-
-	// // If we got command-line arguments.
-	// if(argc > 1)
-	// {
-	//     r = shell->command(argc, argv);
-	// }
-	// else
-	// {
-	//     ioc << IOFormatTextAttr::bold << IOFormatTextFG::blue
-	//         << "===== IOSqueak Tester =====\n" << IOCtrl::endl;
-
-	// 	test_code();
-
-	//     // Shift control to the interactive console.
-	//     shell->interactive();
-	// }
-
-	// // Delete our GoldilocksShell.
-	// delete shell;
+	channel.configure_echo(IOEchoMode::cout);
+
+	GoldilocksShell* shell = new GoldilocksShell(">> ");
+	shell->register_suite<TestSuite_StringifyNumbers>("I-sB13");
+	shell->register_suite<TestSuite_BlueshellTokenizer>("I-sB14");
+	shell->register_suite<TestSuite_LineRenderer>("I-sB15");
+	shell->register_suite<TestSuite_BlueshellHistory>("I-sB16");
+	shell->register_suite<TestSuite_MemDiff>("I-sB17");
+	shell->register_suite<TestSuite_FileSink>("I-sB18");
+	shell->register_suite<TestSuite_BlueshellArgs>("I-sB19");
+	shell->register_suite<TestSuite_BlueshellJobs>("I-sB20");
+	shell->register_suite<TestSuite_StringifyMemory>("I-sB21");
+	shell->register_suite<TestSuite_HexDump>("I-sB22");
+
+	// If we got command-line arguments.
+	if (argc > 1) {
+		r = shell->command(argc, argv);
+	} else {
+		channel << IOFormatTextAttr::bold << IOFormatTextFG::blue
+				<< "===== IOSqueak Tester =====\n"
+				<< IOCtrl::endl;
+
+		test_code();
+
+		// Shift control to the interactive console.
+		shell->interactive();
+	}
+
+	// Delete our GoldilocksShell.
+	delete shell;
 
 	return r;
 }
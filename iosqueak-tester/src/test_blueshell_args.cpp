@@ -0,0 +1,10 @@
+#include "test_blueshell_args.hpp"
+
+void TestSuite_BlueshellArgs::load_tests()
+{
+	register_test("I-tB1901", new Test_ArgsInteger());
+	register_test("I-tB1902", new Test_ArgsReal());
+	register_test("I-tB1903", new Test_ArgsWords());
+	register_test("I-tB1904", new Test_ArgsStructure());
+	register_test("I-tB1905", new Test_ArgsUsage());
+}
@@ -0,0 +1,12 @@
+#include "test_blueshell_history.hpp"
+
+void TestSuite_BlueshellHistory::load_tests()
+{
+	register_test("I-tB1601", new Test_HistoryLogGap());
+	register_test("I-tB1602", new Test_HistoryLogOrder());
+	register_test("I-tB1603", new Test_HistoryLogRuns());
+	register_test("I-tB1604", new Test_HistoryLogEscape());
+	register_test("I-tB1605", new Test_HistoryLogViews());
+	register_test("I-tB1606", new Test_HistoryFuzzyScore());
+	register_test("I-tB1607", new Test_HistorySearch());
+}
@@ -0,0 +1,10 @@
+#include "test_blueshell_jobs.hpp"
+
+void TestSuite_BlueshellJobs::load_tests()
+{
+	register_test("I-tB2001", new Test_JobsStartWait());
+	register_test("I-tB2002", new Test_JobsCancel());
+	register_test("I-tB2003", new Test_JobsStop());
+	register_test("I-tB2004", new Test_JobsForget());
+	register_test("I-tB2005", new Test_JobsFailure());
+}
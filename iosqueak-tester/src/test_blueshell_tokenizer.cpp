@@ -0,0 +1,13 @@
+#include "test_blueshell_tokenizer.hpp"
+
+void TestSuite_BlueshellTokenizer::load_tests()
+{
+	register_test("I-tB1401", new Test_TokenizerViews());
+	register_test("I-tB1402", new Test_TokenizerFuzz());
+
+	// Splitting throughput, against the old process_options().
+	register_test("I-sB1401",
+				  new Bench_Tokenizer(),
+				  true,
+				  new Bench_LegacyProcessOptions());
+}
@@ -0,0 +1,8 @@
+#include "test_filesink.hpp"
+
+void TestSuite_FileSink::load_tests()
+{
+	register_test("I-tB1801", new Test_FileSinkWrite());
+	register_test("I-tB1802", new Test_FileSinkRotate());
+	register_test("I-tB1803", new Test_FileSinkReopen());
+}
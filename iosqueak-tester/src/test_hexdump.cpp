@@ -0,0 +1,7 @@
+#include "test_hexdump.hpp"
+
+void TestSuite_HexDump::load_tests()
+{
+	register_test("I-tB2201", new Test_HexDumpRows());
+	register_test("I-tB2202", new Test_HexDumpLayout());
+}
@@ -0,0 +1,6 @@
+#include "test_linerenderer.hpp"
+
+void TestSuite_LineRenderer::load_tests()
+{
+	register_test("I-tB1501", new Test_LineRendererModel());
+}
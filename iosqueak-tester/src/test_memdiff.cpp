@@ -0,0 +1,15 @@
+#include "test_memdiff.hpp"
+
+void TestSuite_MemDiff::load_tests()
+{
+	register_test("I-tB1701", new Test_MemDiffCompare());
+	register_test("I-tB1702", new Test_MemDiffDump());
+	register_test("I-tB1703", new Test_MemDiffLens());
+	register_test("I-tB1704", new Test_MemDiffDumpChannel());
+
+	// Watching a large region, against comparing a byte at a time.
+	register_test("I-sB1701",
+				  new Bench_MemDiffUpdate(),
+				  true,
+				  new Bench_MemDiffUpdateBytewise());
+}
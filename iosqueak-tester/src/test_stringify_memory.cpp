@@ -0,0 +1,7 @@
+#include "test_stringify_memory.hpp"
+
+void TestSuite_StringifyMemory::load_tests()
+{
+	register_test("I-tB2101", new Test_StringifyByte());
+	register_test("I-tB2102", new Test_StringifyBytes());
+}
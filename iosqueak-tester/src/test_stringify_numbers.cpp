@@ -3,4 +3,31 @@
 void TestSuite_StringifyNumbers::load_tests()
 {
 	register_test("I-tB1301", new Test_LengthifyIntegral());
+	register_test("I-tB1302", new Test_StringifyFloatingPointShortest());
+	register_test("I-tB1303", new Test_StringifyIntegralToChars());
+	register_test("I-tB1304", new Test_LengthifyFloatingPoint());
+
+	// Integer formatting benchmarks: against the old engine...
+	register_test("I-sB1301",
+				  new Bench_StringifyIntegral(IOFormatBase::dec),
+				  true,
+				  new Bench_LegacyStringifyIntegral(10));
+	register_test("I-sB1302",
+				  new Bench_StringifyIntegral(IOFormatBase::hex),
+				  true,
+				  new Bench_LegacyStringifyIntegral(16));
+	register_test("I-sB1303",
+				  new Bench_StringifyIntegral(IOFormatBase::b7),
+				  true,
+				  new Bench_LegacyStringifyIntegral(7));
+
+	// ...and against std::to_chars().
+	register_test("I-sB1304",
+				  new Bench_StringifyIntegralTo(IOFormatBase::dec),
+				  true,
+				  new Bench_ToChars(10));
+	register_test("I-sB1305",
+				  new Bench_StringifyIntegralTo(IOFormatBase::hex),
+				  true,
+				  new Bench_ToChars(16));
 }